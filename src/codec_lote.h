@@ -0,0 +1,171 @@
+#ifndef CODEC_LOTE_H
+#define CODEC_LOTE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// --------------------
+// Lote de registros do log para o coletor (UDP)
+// --------------------
+// Linhas consecutivas do log compartilham quase todo o começo (data, hora,
+// " - Est: "), então cada registro leva só o tamanho do prefixo comum com a
+// linha anterior e o sufixo diferente ("front coding"), ambos com varint.
+// O registro leva os bytes crus da linha, com o "\r\n" (ou "\n") do arquivo:
+// o coletor grava exatamente o que o receptor tem. Linhas maiores que
+// LOTE_LINHA_MAX seguem em vários registros seguidos, sem cortar nada.
+//
+// Lote:  "ELT1" | sessao u32 | inicio u32 | fim u32 | registros u16 |
+//        origem_len u8 | origem | { prefixo varint | sufixo_len varint | sufixo }*
+// ACK:   "ELA1" | sessao u32 | confirmado u32
+//
+// inicio/fim são posições em bytes no /log.txt da sessão; o coletor confirma
+// até onde já tem, e o receptor continua exatamente dali.
+
+#define LOTE_MAX 1400          // cabe num datagrama sem fragmentar
+#define LOTE_LINHA_MAX 255     // bytes por registro; linhas maiores viram vários
+#define LOTE_PEDACO_MAX 1024   // trecho de linha longa que sempre cabe num lote vazio
+#define LOTE_MAGIC "ELT1"
+#define ACK_MAGIC "ELA1"
+#define ACK_TAM 12
+static_assert(19 + 32 + 4 * ((LOTE_PEDACO_MAX + LOTE_LINHA_MAX - 1) / LOTE_LINHA_MAX) + LOTE_PEDACO_MAX <= LOTE_MAX,
+              "pedaço de linha longa não cabe num lote");
+
+inline void poeU32(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+inline uint32_t leU32(const uint8_t *p) { return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+inline size_t poeVarint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+inline bool leVarint(const uint8_t *&p, const uint8_t *fim, uint32_t &v) {
+    v = 0;
+    for (uint8_t desloc = 0; p < fim && desloc < 35; desloc += 7) {
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7F) << desloc;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+class CodificadorLote {
+public:
+    void inicia(uint8_t *destino, size_t capacidade, const char *origem, uint32_t sessao, uint32_t inicio) {
+        buf = destino;
+        cap = capacidade;
+        memcpy(buf, LOTE_MAGIC, 4);
+        poeU32(buf + 4, sessao);
+        poeU32(buf + 8, inicio);
+        fim = inicio;
+        registros = 0;
+        size_t lenOrigem = strlen(origem);
+        if (lenOrigem > 32) lenOrigem = 32;
+        buf[18] = (uint8_t)lenOrigem;
+        memcpy(buf + 19, origem, lenOrigem);
+        pos = 19 + lenOrigem;
+        anteriorLen = 0;
+    }
+
+    // Acrescenta os bytes de uma linha do arquivo, fim de linha incluído.
+    // Retorna false se não couber inteira: o lote deve ser fechado antes.
+    bool adiciona(const char *linha, size_t len) {
+        size_t pedacos = len ? (len + LOTE_LINHA_MAX - 1) / LOTE_LINHA_MAX : 0;
+        if (pos + 4 * pedacos + len > cap) return false;   // 2 varints de até 2 bytes por registro
+        for (size_t ini = 0; ini < len; ini += LOTE_LINHA_MAX) {
+            size_t n = len - ini < LOTE_LINHA_MAX ? len - ini : LOTE_LINHA_MAX;
+            adicionaRegistro(linha + ini, n);
+        }
+        fim += len;
+        return true;
+    }
+
+    size_t finaliza() {
+        poeU32(buf + 12, fim);
+        buf[16] = (uint8_t)registros;
+        buf[17] = (uint8_t)(registros >> 8);
+        return pos;
+    }
+
+    uint16_t totalRegistros() const { return registros; }
+    uint32_t posicaoFim() const { return fim; }
+
+private:
+    void adicionaRegistro(const char *dados, size_t len) {
+        size_t prefixo = 0;
+        while (prefixo < len && prefixo < anteriorLen && dados[prefixo] == anterior[prefixo]) prefixo++;
+        size_t sufixo = len - prefixo;
+        pos += poeVarint(buf + pos, prefixo);
+        pos += poeVarint(buf + pos, sufixo);
+        memcpy(buf + pos, dados + prefixo, sufixo);
+        pos += sufixo;
+        memcpy(anterior, dados, len);
+        anteriorLen = len;
+        registros++;
+    }
+
+    uint8_t *buf = nullptr;
+    size_t cap = 0;
+    size_t pos = 0;
+    uint32_t fim = 0;
+    uint16_t registros = 0;
+    char anterior[LOTE_LINHA_MAX];
+    size_t anteriorLen = 0;
+};
+
+struct CabecalhoLote {
+    uint32_t sessao;
+    uint32_t inicio;
+    uint32_t fim;
+    uint16_t registros;
+    char origem[33];
+};
+
+// Decodifica um lote chamando registro(bytes, len) para cada registro; os
+// registros concatenados são o trecho [inicio, fim) do log, byte a byte.
+// Retorna false se o lote estiver corrompido.
+template <typename F>
+bool decodificaLote(const uint8_t *buf, size_t len, CabecalhoLote &cab, F registro) {
+    if (len < 19 || memcmp(buf, LOTE_MAGIC, 4) != 0) return false;
+    cab.sessao = leU32(buf + 4);
+    cab.inicio = leU32(buf + 8);
+    cab.fim = leU32(buf + 12);
+    cab.registros = buf[16] | (buf[17] << 8);
+    size_t lenOrigem = buf[18];
+    if (lenOrigem > 32 || 19 + lenOrigem > len) return false;
+    memcpy(cab.origem, buf + 19, lenOrigem);
+    cab.origem[lenOrigem] = '\0';
+
+    const uint8_t *p = buf + 19 + lenOrigem;
+    const uint8_t *fim = buf + len;
+    char linha[LOTE_LINHA_MAX];
+    uint32_t linhaLen = 0;
+    for (uint16_t r = 0; r < cab.registros; r++) {
+        uint32_t prefixo, sufixo;
+        if (!leVarint(p, fim, prefixo) || !leVarint(p, fim, sufixo)) return false;
+        if (prefixo > linhaLen || prefixo + sufixo > LOTE_LINHA_MAX || sufixo > (size_t)(fim - p)) return false;
+        memcpy(linha + prefixo, p, sufixo);
+        p += sufixo;
+        linhaLen = prefixo + sufixo;
+        registro(linha, (size_t)linhaLen);
+    }
+    return true;
+}
+
+inline size_t montaAck(uint8_t *buf, uint32_t sessao, uint32_t confirmado) {
+    memcpy(buf, ACK_MAGIC, 4);
+    poeU32(buf + 4, sessao);
+    poeU32(buf + 8, confirmado);
+    return ACK_TAM;
+}
+
+inline bool leAck(const uint8_t *buf, size_t len, uint32_t &sessao, uint32_t &confirmado) {
+    if (len < ACK_TAM || memcmp(buf, ACK_MAGIC, 4) != 0) return false;
+    sessao = leU32(buf + 4);
+    confirmado = leU32(buf + 8);
+    return true;
+}
+
+#endif // CODEC_LOTE_H
@@ -0,0 +1,201 @@
+#ifndef ENVIADOR_H
+#define ENVIADOR_H
+
+// --------------------
+// Envio do log para um coletor (store-and-forward)
+// --------------------
+// Com COLETOR_HOST definido, o receptor conecta em NOME_REDE/SENHA (modo STA,
+// além do softAP) e manda os registros novos do /log.txt em lotes UDP
+// compactados (codec_lote.h). A posição confirmada pelo coletor (absoluta,
+// log_rotativo.h) fica em /upload_ofs junto com a sessão do envio, então
+// reconexões, reboots e rotações retomam exatamente do último byte
+// confirmado. Sem ACK, repete com backoff exponencial.
+//
+// Atenção: ao associar no roteador o rádio passa para o canal dele; os
+// transmissores ESP-NOW precisam usar o mesmo canal.
+
+#include "log_rotativo.h"
+
+#ifdef COLETOR_HOST
+
+#include <WiFiUdp.h>
+#include "codec_lote.h"
+
+#ifndef COLETOR_PORTA
+#define COLETOR_PORTA 5005
+#endif
+#ifndef UPLOAD_INTERVAL_MS
+#define UPLOAD_INTERVAL_MS 30000   // espera entre lotes quando já está em dia
+#endif
+#ifndef UPLOAD_ACK_MS
+#define UPLOAD_ACK_MS 800          // espera pelo ACK de um lote
+#endif
+#define UPLOAD_BACKOFF_MAX_MS 60000
+#define UPLOAD_LEITURA 2048
+#define UPLOAD_PATH "/upload_ofs"
+
+class Enviador {
+public:
+    explicit Enviador(LogRotativo &log) : log(log) {}
+
+    void begin() {
+        String mac = WiFi.macAddress();
+        strncpy(origem, mac.c_str(), sizeof(origem));
+        origem[sizeof(origem)-1] = '\0';
+
+        File f = LittleFS.open(UPLOAD_PATH, "r");
+        if (f && f.read((uint8_t*)&estado, sizeof(estado)) == sizeof(estado)) {
+            Serial.printf("Coletor: sessão %08lx, retomando em %lu\n", (unsigned long)estado.sessao, (unsigned long)estado.confirmado);
+        } else {
+            novaSessao(log.inicio());
+        }
+        if (f) f.close();
+
+        WiFi.begin(NOME_REDE, SENHA);
+        udp.begin(COLETOR_PORTA);
+    }
+
+    // Log zerado: começa uma sessão nova a partir do byte 0
+    void clear() {
+        novaSessao(log.inicio());
+        aguardando = false;
+        tentativas = 0;
+        proximo = millis();
+    }
+
+    void tick() {
+        if (WiFi.status() != WL_CONNECTED) return;
+        unsigned long now = millis();
+
+        if (aguardando) {
+            if (recebeAck(now)) return;
+            if (now - enviadoEm < UPLOAD_ACK_MS) return;
+            aguardando = false;
+            if (tentativas < 7) tentativas++;
+            unsigned long espera = (unsigned long)UPLOAD_ACK_MS << tentativas;
+            proximo = now + (espera > UPLOAD_BACKOFF_MAX_MS ? UPLOAD_BACKOFF_MAX_MS : espera);
+            return;
+        }
+        if ((long)(now - proximo) < 0) return;
+
+        size_t len = montaLote();
+        if (codificador.totalRegistros() == 0) {
+            proximo = now + UPLOAD_INTERVAL_MS;
+            return;
+        }
+        udp.beginPacket(COLETOR_HOST, COLETOR_PORTA);
+        udp.write(lote, len);
+        udp.endPacket();
+        aguardando = true;
+        enviadoEm = now;
+        bytesEnviados += len;
+    }
+
+    uint32_t confirmado() const { return estado.confirmado; }
+    uint32_t bytesEnviados = 0;
+    uint32_t registrosConfirmados = 0;
+
+private:
+    struct Estado {
+        uint32_t sessao;
+        uint32_t confirmado;   // posição absoluta do log até onde o coletor já tem
+    } estado = {0, 0};
+
+    LogRotativo &log;
+    WiFiUDP udp;
+    CodificadorLote codificador;
+    char origem[18];
+    uint8_t lote[LOTE_MAX];
+    uint8_t leitura[UPLOAD_LEITURA];
+    bool aguardando = false;
+    bool loteCheio = false;
+    uint8_t tentativas = 0;
+    unsigned long enviadoEm = 0;
+    unsigned long proximo = 0;
+
+    // O coletor aceita o primeiro lote de uma sessão em qualquer posição
+    void novaSessao(uint32_t inicio) {
+#ifdef ESP32
+        estado.sessao = esp_random();
+#else
+        estado.sessao = RANDOM_REG32;
+#endif
+        estado.confirmado = inicio;
+        salva();
+    }
+
+    void salva() {
+        File f = LittleFS.open(UPLOAD_PATH, "w");
+        if (f) { f.write((const uint8_t*)&estado, sizeof(estado)); f.close(); }
+    }
+
+    // Lê a partir da posição confirmada e codifica só linhas completas (uma
+    // linha maior que a leitura inteira vai em pedaços, para não travar)
+    size_t montaLote() {
+        codificador.inicia(lote, sizeof(lote), origem, estado.sessao, estado.confirmado);
+        loteCheio = false;
+        if (estado.confirmado > log.fim() || estado.confirmado < log.inicio()) {
+            // Log zerado por fora, ou a rotação descartou o que o coletor não tinha:
+            // não há como continuar a sessão, recomeça do mais antigo guardado
+            novaSessao(log.inicio());
+            return 0;
+        }
+        // Segmentos terminam em linha inteira, então uma leitura curta na divisa basta
+        size_t lido = log.le(estado.confirmado, leitura, sizeof(leitura));
+        bool haMais = estado.confirmado + lido < log.fim();
+
+        size_t inicio = 0;
+        while (inicio < lido) {
+            uint8_t *nl = (uint8_t*)memchr(leitura + inicio, '\n', lido - inicio);
+            size_t fimLinha;
+            if (nl) fimLinha = nl - leitura + 1;
+            else if (inicio == 0 && lido == sizeof(leitura)) fimLinha = lido;
+            else break;   // linha ainda incompleta
+            if (inicio == 0 && fimLinha > LOTE_PEDACO_MAX) fimLinha = LOTE_PEDACO_MAX;   // linha longa: em pedaços
+            if (!codificador.adiciona((const char*)leitura + inicio, fimLinha - inicio)) {
+                loteCheio = true;
+                break;
+            }
+            inicio = fimLinha;
+        }
+        if (haMais) loteCheio = true;
+        return codificador.finaliza();
+    }
+
+    bool recebeAck(unsigned long now) {
+        int n = udp.parsePacket();
+        if (n <= 0) return false;
+        uint8_t ack[ACK_TAM];
+        int lido = udp.read(ack, sizeof(ack));
+        uint32_t sessao, conf;
+        if (lido <= 0 || !leAck(ack, lido, sessao, conf) || sessao != estado.sessao) return false;
+
+        aguardando = false;
+        tentativas = 0;
+        // O coletor é a referência: se ele tiver menos do que achamos, reenviamos dali
+        if (conf == codificador.posicaoFim()) registrosConfirmados += codificador.totalRegistros();
+        if (conf != estado.confirmado) {
+            estado.confirmado = conf;
+            salva();
+        }
+        // Atrasado: emenda o próximo lote; em dia: espera juntar registros
+        proximo = (loteCheio && conf == codificador.posicaoFim()) ? now : now + UPLOAD_INTERVAL_MS;
+        return true;
+    }
+};
+
+#else
+
+// Sem coletor configurado: nada a enviar
+class Enviador {
+public:
+    explicit Enviador(LogRotativo &) {}
+    void begin() {}
+    void clear() {}
+    void tick() {}
+    uint32_t confirmado() const { return 0; }
+};
+
+#endif // COLETOR_HOST
+
+#endif // ENVIADOR_H
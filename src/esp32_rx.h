@@ -6,132 +6,382 @@
 #include <LittleFS.h>
 #include <SD.h>
 #include <SPI.h>
+#include <memory>
 
-#ifndef QTDE_TX
-#define QTDE_TX 3
-#endif
-#ifndef TEMP_MIN
-#define TEMP_MIN 5.0
-#endif
-#ifndef TEMP_MAX
-#define TEMP_MAX 10.0
-#endif
+#include "politicas_arduino.h"
+#include "log_rotativo.h"
+#include "sincronia_log.h"
+#include "espelho_sd.h"
+#include "enviador.h"
 
 #define FLASH_BTN 0
 #define SD_CS_PIN 33
 #define ONEWIRE_PIN 32
 
-#define LISTA_TX { "Garrafa1","Garrafa2","Garrafa3","Isopor1","Isopor2","Isopor3","Botuflex1","Botuflex2","Botuflex3","Extra" }
+// --------------------
+// Tarefas e filas
+// --------------------
+// onDataRecv (tarefa do Wi-Fi) só enfileira o quadro. A ingestão roda no
+// core 0, junto do rádio; gravação, publicação SSE, amostragem e cópia rodam
+// no core 1, ao lado do AsyncTCP. O loop() do Arduino fica parado.
+//
+//   Wi-Fi cb -> filaQuadros -> ingestao ---+        (anúncios: ingestao -> registro -> atribuição)
+//                              amostrador -+-> filaLog -> gravacao -> filaWeb -> web (SSE)
+//                                                         |
+//                                             LittleFS (posições absolutas) -> copia -> SD, coletor
+//
+// A gravação só acrescenta e rotaciona, e regrava no LittleFS as estações
+// que o registro marcou (pareamento, edição pela web). Espelho SD e coletor
+// ficam na tarefa de cópia, de menor prioridade, que lê o LittleFS pela
+// posição absoluta: cartão sumido ou coletor fora do ar nunca seguram a fila
+// do log.
+#define FILA_QUADROS 32
+#define FILA_LOG 32
+#define FILA_WEB 16
+
+#define PRIO_INGESTAO 5      // acima da gravação: um burst nunca espera o flash
+#define PRIO_GRAVACAO 4
+#define PRIO_WEB 3
+#define PRIO_AMOSTRADOR 2
+#define PRIO_COPIA 1         // SD e coletor: só no tempo que sobra
+#define COPIA_MS 50          // passo da cópia quando não há pedido de limpeza
+#define CORE_RADIO 0
+#define CORE_APP 1
 
-RTC_DS1307 rtc;
 AsyncWebServer server(80);
 AsyncEventSource events("/events");
 OneWire oneWire(ONEWIRE_PIN);
 DallasTemperature sensors(&oneWire);
-
-struct StationState {
-    char nome[16];
-    bool lowAlert;
-    bool highAlert;
+LogRotativo arquivoLog;
+EspelhoSD<decltype(SD), const char*> espelho(arquivoLog, SD, SD_CS_PIN, FILE_APPEND);
+Enviador enviador(arquivoLog);
+
+// Quadro em trânsito do callback do Wi-Fi para a ingestão (dados ou anúncio)
+struct QuadroRecebido {
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t dados[sizeof(SensorData)];
 };
+static_assert(sizeof(QuadroAnuncio) <= sizeof(SensorData), "anúncio maior que o quadro de dados");
 
-SensorData stationData[QTDE_TX];
-StationState stationStates[QTDE_TX];
-const char* expectedNames[10] = LISTA_TX;
+// Linha do log em trânsito entre tarefas (limpar = pedido do botão FLASH)
+struct LinhaLog {
+    char texto[LINHA_MAX];
+    bool limpar;
+};
 
-unsigned long lastAmbientMillis = 0;
-bool receivedStation[QTDE_TX] = { false };
+// Tempo de CPU e itens processados por tarefa
+struct EstatTarefa {
+    const char *nome;
+    TaskHandle_t handle;
+    volatile uint64_t ocupadoUs;
+    volatile uint32_t itens;
+};
 
-String pad2(int value) { return (value < 10 ? "0" : "") + String(value); }
+// Profundidade e perdas por fila
+struct EstatFila {
+    const char *nome;
+    QueueHandle_t fila;
+    volatile uint32_t maxOcupacao;
+    volatile uint32_t descartes;
+};
 
-void writeLog(const String &entry) {
-    Serial.println(entry);
+enum { T_INGESTAO, T_GRAVACAO, T_WEB, T_AMOSTRADOR, T_COPIA, N_TAREFAS };
+EstatTarefa tarefas[N_TAREFAS] = {
+    { "ingestao", nullptr, 0, 0 }, { "gravacao", nullptr, 0, 0 },
+    { "web", nullptr, 0, 0 }, { "amostrador", nullptr, 0, 0 },
+    { "copia", nullptr, 0, 0 },
+};
+EstatFila filaQuadros = { "quadros", nullptr, 0, 0 };
+EstatFila filaLog = { "log", nullptr, 0, 0 };
+EstatFila filaWeb = { "web", nullptr, 0, 0 };
+
+// Enfileira com contagem de ocupação máxima e descartes
+bool enfileira(EstatFila &f, const void *item, TickType_t espera) {
+    if (xQueueSend(f.fila, item, espera) != pdTRUE) { f.descartes++; return false; }
+    uint32_t ocupacao = uxQueueMessagesWaiting(f.fila);
+    if (ocupacao > f.maxOcupacao) f.maxOcupacao = ocupacao;
+    return true;
+}
 
-    // LittleFS
-    File logFile = LittleFS.open("/log.txt", "a");
-    if (logFile) { logFile.println(entry); logFile.close(); }
+// --------------------
+// Políticas do núcleo (nucleo_receptor.h) no ESP32
+// --------------------
+// Responde ao anúncio com o ID curto. Só um peer temporário por vez: o
+// ESP-NOW tem poucos peers e o receptor só fala com o TX no pareamento.
+struct RadioEsp32 {
+    static bool responde(const uint8_t *mac, const uint8_t *buf, size_t len) {
+        static uint8_t ultimoPeer[6];
+        static bool temPeer = false;
+        if (temPeer && memcmp(ultimoPeer, mac, 6) != 0) {
+            esp_now_del_peer(ultimoPeer);
+            temPeer = false;
+        }
+        if (!temPeer) {
+            esp_now_peer_info_t peer = {};
+            memcpy(peer.peer_addr, mac, 6);
+            peer.channel = 0;               // canal atual
+            peer.ifidx = WIFI_IF_STA;
+            temPeer = esp_now_add_peer(&peer) == ESP_OK;
+            memcpy(ultimoPeer, mac, 6);
+        }
+        return esp_now_send(mac, buf, len) == ESP_OK;
+    }
+};
 
-    // SD Card
-    if (SD.begin(SD_CS_PIN)) {
-        File sdFile = SD.open("/log.txt", FILE_APPEND);
-        if (sdFile) { sdFile.println(entry); sdFile.close(); }
+// Entrega a linha à tarefa de gravação (quem grava no LittleFS e publica no SSE)
+struct ArmazenamentoEsp32 : ArquivosLittleFS {
+    static void grava(const char *texto) {
+        LinhaLog linha;
+        strncpy(linha.texto, texto, sizeof(linha.texto));
+        linha.texto[sizeof(linha.texto)-1] = '\0';
+        linha.limpar = false;
+        enfileira(filaLog, &linha, pdMS_TO_TICKS(100));
     }
+};
+
+NucleoReceptor<RadioEsp32, RelogioRtc, ArmazenamentoEsp32, WebString> nucleo;
+
+// Callback na tarefa do Wi-Fi: só valida e enfileira
+void onDataRecv(const esp_now_recv_info_t *info, const uint8_t *incomingData, int len) {
+    if (!quadroValido(incomingData, len) && !anuncioValido(incomingData, len)) return;
+
+    QuadroRecebido q = {};
+    memcpy(q.mac, info->src_addr, 6);
+    q.len = min((size_t)len, sizeof(q.dados));
+    memcpy(q.dados, incomingData, q.len);
+    enfileira(filaQuadros, &q, 0);
+}
 
-    // SSE
-    events.send(entry.c_str(), "message", millis());
+// --------------------
+// Corpos das tarefas
+// --------------------
+void tarefaIngestao(void *) {
+    EstatTarefa &t = tarefas[T_INGESTAO];
+    QuadroRecebido q;
+    unsigned long ultimaVerificacao = millis();
+    for (;;) {
+        bool chegou = xQueueReceive(filaQuadros.fila, &q, pdMS_TO_TICKS(1000)) == pdTRUE;
+        int64_t t0 = esp_timer_get_time();
+        if (chegou) { nucleo.processa(q.mac, q.dados, q.len); t.itens++; }
+        if (millis() - ultimaVerificacao >= SILENCIO_MS) {
+            nucleo.verificaSilencio();
+            ultimaVerificacao = millis();
+        }
+        t.ocupadoUs += esp_timer_get_time() - t0;
+    }
 }
 
-int getStationIndex(const char* nome) {
-    for (int i = 0; i < QTDE_TX; i++) {
-        if (strcmp(stationStates[i].nome, nome) == 0) return i;
+// Drena a fila de uma vez: várias linhas num único open/close do LittleFS.
+// Só acrescenta e rotaciona; SD e coletor ficam com a tarefa de cópia. O
+// registro de estações também é gravado aqui, no máximo 100 ms depois da
+// alteração: ingestão e servidor web nunca esperam o flash.
+void tarefaGravacao(void *) {
+    EstatTarefa &t = tarefas[T_GRAVACAO];
+    LinhaLog linha;
+    for (;;) {
+        bool chegou = xQueueReceive(filaLog.fila, &linha, pdMS_TO_TICKS(100)) == pdTRUE;
+        int64_t t0 = esp_timer_get_time();
+        if (chegou) {
+            File logFile;
+            do {
+                if (linha.limpar) {
+                    arquivoLog.fecha(logFile);
+                    arquivoLog.clear();
+                    xTaskNotifyGive(tarefas[T_COPIA].handle);   // a cópia zera SD e coletor
+                    continue;
+                }
+                Serial.println(linha.texto);
+                if (!logFile) logFile = arquivoLog.abre();
+                if (logFile) logFile.println(linha.texto);
+                enfileira(filaWeb, &linha, 0);   // SSE é best-effort
+                t.itens++;
+            } while (xQueueReceive(filaLog.fila, &linha, 0) == pdTRUE);
+            arquivoLog.fecha(logFile);   // publica o novo fim e rotaciona se encheu
+        }
+        nucleo.registro.persiste();
+        t.ocupadoUs += esp_timer_get_time() - t0;
     }
-    return -1;
 }
 
-void logStation(const char* nome_tx, float temp) {
-    int idx = getStationIndex(nome_tx);
-    if (idx == -1) return;
-
-    String entry;
-    DateTime now = rtc.now();
-    entry += pad2(now.day()) + "/" + pad2(now.month()) + "/" + String(now.year()) + " ";
-    entry += pad2(now.hour()) + ":" + pad2(now.minute()) + ":" + pad2(now.second());
-    entry += " - Est: " + String(nome_tx) + " | Temp: " + String(temp, 2) + " \u00B0C";
-
-    if (temp < TEMP_MIN && !stationStates[idx].lowAlert) {
-        entry += " <<< ALERTA: abaixo de " + String(TEMP_MIN) + " \u00B0C!";
-        stationStates[idx].lowAlert = true;
-        stationStates[idx].highAlert = false;
-    } else if (temp > TEMP_MAX && !stationStates[idx].highAlert) {
-        entry += " <<< ALERTA: acima de " + String(TEMP_MAX) + " \u00B0C";
-        stationStates[idx].highAlert = true;
-        stationStates[idx].lowAlert = false;
-    } else if (temp >= TEMP_MIN && temp <= TEMP_MAX) {
-        if (stationStates[idx].lowAlert || stationStates[idx].highAlert)
-            entry += " <<< NORMALIZADO";
-        stationStates[idx].lowAlert = false;
-        stationStates[idx].highAlert = false;
+// Cópia para o SD e envio ao coletor, lendo o LittleFS pela posição absoluta.
+// Sondagem do cartão e backoff do coletor podem demorar à vontade aqui.
+void tarefaCopia(void *) {
+    EstatTarefa &t = tarefas[T_COPIA];
+    for (;;) {
+        bool limpar = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(COPIA_MS)) > 0;
+        int64_t t0 = esp_timer_get_time();
+        if (limpar) {
+            espelho.clear();
+            enviador.clear();
+        }
+        uint32_t antes = espelho.marca() + enviador.confirmado();
+        espelho.tick();
+        enviador.tick();
+        if (espelho.marca() + enviador.confirmado() != antes) t.itens++;   // passos que andaram
+        t.ocupadoUs += esp_timer_get_time() - t0;
     }
+}
 
-    writeLog(entry);
+void tarefaWeb(void *) {
+    EstatTarefa &t = tarefas[T_WEB];
+    LinhaLog linha;
+    for (;;) {
+        if (xQueueReceive(filaWeb.fila, &linha, portMAX_DELAY) != pdTRUE) continue;
+        int64_t t0 = esp_timer_get_time();
+        events.send(linha.texto, "message", millis());
+        t.itens++;
+        t.ocupadoUs += esp_timer_get_time() - t0;
+    }
 }
 
-void logAmbient() {
-    sensors.requestTemperatures();
-    float ambientTemp = sensors.getTempCByIndex(0);
+// Botão FLASH a cada 50 ms e temperatura ambiente a cada AMBIENTE_MS
+void tarefaAmostrador(void *) {
+    EstatTarefa &t = tarefas[T_AMOSTRADOR];
+    TickType_t acordar = xTaskGetTickCount();
+    unsigned long ultimoAmbiente = 0;
+    for (;;) {
+        vTaskDelayUntil(&acordar, pdMS_TO_TICKS(50));
+        int64_t t0 = esp_timer_get_time();
+        if (digitalRead(FLASH_BTN) == LOW) {
+            Serial.println("Botão FLASH pressionado: log zerado.");
+            LinhaLog pedido = {};
+            pedido.limpar = true;
+            enfileira(filaLog, &pedido, portMAX_DELAY);
+            vTaskDelay(pdMS_TO_TICKS(500));   // debounce
+            acordar = xTaskGetTickCount();
+        }
+        if (millis() - ultimoAmbiente >= AMBIENTE_MS) {
+            sensors.requestTemperatures();
+            nucleo.amostraAmbiente(lerCentiPorIndice(sensors, 0));
+            ultimoAmbiente = millis();
+            t.itens++;
+        }
+        t.ocupadoUs += esp_timer_get_time() - t0;
+    }
+}
 
-    DateTime now = rtc.now();
-    String entry = pad2(now.day()) + "/" + pad2(now.month()) + "/" + String(now.year()) + " ";
-    entry += pad2(now.hour()) + ":" + pad2(now.minute()) + ":" + pad2(now.second());
-    entry += " - Ambiente: " + String(ambientTemp, 2) + " \u00B0C";
+// /stats: CPU por tarefa desde a última consulta, ocupação das filas e clientes SSE
+void handleStats(AsyncWebServerRequest *request) {
+    static int64_t ultimaConsulta = 0;
+    static uint64_t ocupadoAnterior[N_TAREFAS] = {0};
+    int64_t agora = esp_timer_get_time();
+    int64_t janela = agora - ultimaConsulta;
+    ultimaConsulta = agora;
+
+    String json = "{\"tarefas\":[";
+    for (int i = 0; i < N_TAREFAS; i++) {
+        EstatTarefa &t = tarefas[i];
+        uint64_t ocupado = t.ocupadoUs;
+        float cpu = janela > 0 ? 100.0f * (ocupado - ocupadoAnterior[i]) / janela : 0;
+        ocupadoAnterior[i] = ocupado;
+        if (i) json += ",";
+        json += "{\"nome\":\"" + String(t.nome) + "\",\"cpu_pct\":" + String(cpu, 2);
+        json += ",\"itens\":" + String(t.itens);
+        json += ",\"pilha_livre\":" + String(uxTaskGetStackHighWaterMark(t.handle)) + "}";
+    }
+    json += "],\"filas\":[";
+    EstatFila *filas[] = { &filaQuadros, &filaLog, &filaWeb };
+    for (int i = 0; i < 3; i++) {
+        EstatFila &f = *filas[i];
+        if (i) json += ",";
+        json += "{\"nome\":\"" + String(f.nome) + "\",\"ocupacao\":" + String(uxQueueMessagesWaiting(f.fila));
+        json += ",\"max\":" + String(f.maxOcupacao) + ",\"descartes\":" + String(f.descartes) + "}";
+    }
+    json += "],\"clientes_sse\":" + String(events.count()) + "}";
+    request->send(200, "application/json", json);
+}
 
-    writeLog(entry);
+// /energia: último perfil de cada estação (fases em unidades de 100 µs), para tools/energia.cpp
+void handleEnergia(AsyncWebServerRequest *request) {
+    String csv;
+    nucleo.energiaCsv(csv);
+    request->send(200, "text/csv", csv);
 }
 
-void onDataRecv(const esp_now_recv_info_t *info, const uint8_t *incomingData, int len) {
-    if (len != sizeof(SensorData)) return;
+// /estacoes?de=0: página do registro em JSON (PAGINA_ESTACOES por vez)
+void handleEstacoes(AsyncWebServerRequest *request) {
+    const AsyncWebParameter *p = request->getParam("de");
+    String json;
+    nucleo.estacoesJson(json, p ? p->value().toInt() : 0);
+    request->send(200, "application/json", json);
+}
 
-    SensorData data;
-    memcpy(&data, incomingData, sizeof(SensorData));
+// Parâmetro do corpo (form) ou da query
+const char *argWeb(AsyncWebServerRequest *request, const char *nome) {
+    const AsyncWebParameter *p = request->getParam(nome, true);
+    if (!p) p = request->getParam(nome);
+    return p ? p->value().c_str() : nullptr;
+}
 
-    int idx = getStationIndex(data.nome_tx);
-    if (idx != -1) {
-        stationData[idx] = data;
-        receivedStation[idx] = true;
-        logStation(data.nome_tx, data.temp);
-    }
+// POST /estacoes id=3&nome=Geladeira2&min=2.5&max=8 (com sonda=2, só aquela
+// sonda): vale na hora, sem reiniciar
+void handleEditaEstacao(AsyncWebServerRequest *request) {
+    const char *msg;
+    int codigo = nucleo.editaEstacao(argWeb(request, "id"), argWeb(request, "sonda"), argWeb(request, "nome"),
+                                     argWeb(request, "min"), argWeb(request, "max"), msg);
+    request->send(codigo, "text/plain", msg);
 }
 
+// /log: log inteiro, faixa (Range), condicional (If-None-Match) ou incremental (?since=cursor).
+// Posições e cursores são absolutos na sessão (sincronia_log.h).
 void handleLog(AsyncWebServerRequest *request) {
-    if (LittleFS.exists("/log.txt")) {
-        request->send(LittleFS, "/log.txt", "text/plain", true);
+    uint32_t sessao = arquivoLog.sessao(), inicio = arquivoLog.inicio(), fim = arquivoLog.fim();
+    const AsyncWebParameter *since = request->getParam("since");
+    if (fim == inicio && !since) {
+        if (espelho.estaMontado() && SD.exists(LOG_PATH)) request->send(SD, LOG_PATH, "text/plain", true);
+        else request->send(200, "text/plain", "Nenhum log encontrado.");
         return;
     }
-    if (SD.exists("/log.txt")) {
-        request->send(SD, "/log.txt", "text/plain", true);
-        return;
+
+    const AsyncWebHeader *range = request->getHeader("Range");
+    const AsyncWebHeader *inm = request->getHeader("If-None-Match");
+    RespostaLog r = resolvePedidoLog(since ? since->value().c_str() : nullptr,
+                                     range ? range->value().c_str() : nullptr,
+                                     inm ? inm->value().c_str() : nullptr, sessao, inicio, fim);
+
+    AsyncWebServerResponse *resp;
+    if (r.codigo == 200 || r.codigo == 206) {
+        uint32_t de = r.de, ate = r.ate;
+        // Lido direto dos segmentos pela posição absoluta, com a rotação adiada
+        // até o fim da resposta. Se ela vier mesmo assim (cliente lento demais),
+        // a conexão cai em vez de terminar num corpo mais curto que o anunciado:
+        // fechar aqui dentro liberaria o request no meio do envio, então o filler
+        // só para de entregar dados e o timeout de recepção do AsyncTCP derruba
+        // o cliente no próximo poll, fora do servidor web.
+        auto fixado = std::make_shared<bool>(true);
+        auto solta = [fixado]() { if (*fixado) { *fixado = false; arquivoLog.solta(); } };
+        arquivoLog.fixa();
+        request->onDisconnect(solta);
+        resp = request->beginResponse("text/plain; charset=utf-8", ate - de,
+            [de, ate, request, solta](uint8_t *buf, size_t max, size_t index) -> size_t {
+                size_t resto = ate - de - index;
+                size_t lido = arquivoLog.le(de + index, buf, max < resto ? max : resto);
+                if (lido == 0 && resto > 0) {
+                    solta();
+                    request->client()->setRxTimeout(1);
+                    return 0;
+                }
+                if (lido == resto) solta();
+                return lido;
+            });
+        resp->setCode(r.codigo);
+    } else {
+        resp = request->beginResponse(r.codigo);
     }
-    request->send(200, "text/plain", "Nenhum log encontrado.");
+    if (r.codigo == 206) resp->addHeader("Content-Range", "bytes " + String(r.de) + "-" + String(r.ate - 1) + "/" + String(fim));
+    if (r.codigo == 416) resp->addHeader("Content-Range", "bytes */" + String(fim));
+
+    char etag[LOG_CURSOR_MAX + 2], cursor[LOG_CURSOR_MAX];
+    formataEtag(etag, sizeof(etag), sessao, fim);
+    formataCursor(cursor, sizeof(cursor), sessao, r.ate);
+    resp->addHeader("ETag", etag);
+    resp->addHeader("Accept-Ranges", "bytes");
+    resp->addHeader("X-Log-Cursor", cursor);
+    resp->addHeader("X-Log-Inicio", String(inicio));
+    if (r.reinicio) resp->addHeader("X-Log-Reinicio", "1");
+    if (r.lacuna) resp->addHeader("X-Log-Lacuna", String(r.lacuna));
+    request->send(resp);
 }
 
 void setup() {
@@ -140,19 +390,17 @@ void setup() {
 
     if (!rtc.begin()) { Serial.println("Erro: RTC DS1307 não encontrado!"); while (1); }
     if (!LittleFS.begin()) { Serial.println("Falha ao montar LittleFS"); while (1); }
-    if (!SD.begin(SD_CS_PIN)) { Serial.println("Falha ao inicializar SD"); }
+    arquivoLog.begin();
+    espelho.begin();
 
     sensors.begin();
     sensors.setResolution(12);
 
-    for (int i = 0; i < QTDE_TX; i++) {
-        strncpy(stationStates[i].nome, expectedNames[i], sizeof(stationStates[i].nome));
-        stationStates[i].lowAlert = false;
-        stationStates[i].highAlert = false;
-    }
+    Serial.printf("Registro: %u estações\n", nucleo.begin());   // pareadas em boots anteriores
 
     WiFi.mode(WIFI_AP_STA);
     WiFi.softAP("RECEPTOR","12345678");
+    enviador.begin();
 
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
         String html = R"rawliteral(
@@ -170,40 +418,31 @@ void setup() {
         request->send(200,"text/html",html);
     });
     server.on("/log", HTTP_GET, handleLog);
+    server.on("/stats", HTTP_GET, handleStats);
+    server.on("/energia", HTTP_GET, handleEnergia);
+    server.on("/estacoes", HTTP_GET, handleEstacoes);
+    server.on("/estacoes", HTTP_POST, handleEditaEstacao);
     server.addHandler(&events);
     server.begin();
 
+    filaQuadros.fila = xQueueCreate(FILA_QUADROS, sizeof(QuadroRecebido));
+    filaLog.fila = xQueueCreate(FILA_LOG, sizeof(LinhaLog));
+    filaWeb.fila = xQueueCreate(FILA_WEB, sizeof(LinhaLog));
+    xTaskCreatePinnedToCore(tarefaIngestao, "ingestao", 4096, nullptr, PRIO_INGESTAO, &tarefas[T_INGESTAO].handle, CORE_RADIO);
+    xTaskCreatePinnedToCore(tarefaGravacao, "gravacao", 6144, nullptr, PRIO_GRAVACAO, &tarefas[T_GRAVACAO].handle, CORE_APP);
+    xTaskCreatePinnedToCore(tarefaWeb, "web", 4096, nullptr, PRIO_WEB, &tarefas[T_WEB].handle, CORE_APP);
+    xTaskCreatePinnedToCore(tarefaAmostrador, "amostrador", 4096, nullptr, PRIO_AMOSTRADOR, &tarefas[T_AMOSTRADOR].handle, CORE_APP);
+    xTaskCreatePinnedToCore(tarefaCopia, "copia", 6144, nullptr, PRIO_COPIA, &tarefas[T_COPIA].handle, CORE_APP);
+
     if (esp_now_init() != ESP_OK) { Serial.println("Erro ESP-NOW"); return; }
     esp_now_register_recv_cb(onDataRecv);
 
-    if (LittleFS.exists("/log.txt")) {
-    LittleFS.remove("/log.txt");
-    Serial.println("Log apagado do LittleFS.");
-    }
-    if (SD.begin(SD_CS_PIN)) {
-        if (SD.exists("/log.txt")) {
-            SD.remove("/log.txt");
-            Serial.println("Log apagado do SD.");
-        }
-    }
-
     Serial.println("Pronto para receber dados...");
 }
 
+// Todo o trabalho está nas tarefas fixadas em core; o loop do Arduino só dorme
 void loop() {
-    unsigned long now = millis();
-
-    if (digitalRead(FLASH_BTN) == LOW) {
-        Serial.println("Botão FLASH pressionado: log zerado.");
-        if (LittleFS.exists("/log.txt")) LittleFS.remove("/log.txt");
-        if (SD.exists("/log.txt")) SD.remove("/log.txt");
-        delay(500);
-    }
-
-    if (now - lastAmbientMillis >= 60000) {
-        logAmbient();
-        lastAmbientMillis = now;
-    }
+    vTaskDelay(portMAX_DELAY);
 }
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef ESP32_TX_H
 #define ESP32_TX_H
 
+#include "politica_envio.h"
+
 // --------------------
 // Configurações do sensor
 // --------------------
@@ -10,10 +12,8 @@ DallasTemperature sensors(&oneWire);
 // --------------------
 // MAC do receptor
 // --------------------
-#ifndef MAC_RX
-#define MAC_RX {MAC_RX_0, MAC_RX_1, MAC_RX_2, MAC_RX_3, MAC_RX_4, MAC_RX_5}  // fallback
-#endif
-uint8_t mac_rx[6] = MAC_RX;
+// Vem do pareamento (guardado em rtcState.macRx)
+const uint8_t MAC_BROADCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
 // --------------------
 // Intervalos de envio
@@ -32,61 +32,180 @@ const uint64_t SEND_INTERVAL = hoursToUs(TEMPO);
 #error "INTERVALO inválido! Use SEGUNDOS, MINUTOS ou HORAS."
 #endif
 
+// Estado da política de envio (sobrevive ao deep sleep)
+RTC_DATA_ATTR TxRtcState rtcState;
+
+// Resultado do último envio: -1 aguardando, 0 falhou, 1 ACK recebido
+volatile int8_t statusEnvio = -1;
+
+void onDataSent(const uint8_t *mac, esp_now_send_status_t status) {
+    statusEnvio = (status == ESP_NOW_SEND_SUCCESS) ? 1 : 0;
+}
+
+bool adicionaPeer(const uint8_t *mac) {
+    esp_now_peer_info_t peerInfo;
+    memset(&peerInfo, 0, sizeof(peerInfo));
+    memcpy(peerInfo.peer_addr, mac, 6);
+    peerInfo.channel = 1;           // canal do receptor (confira no RX)
+    peerInfo.encrypt = false;
+    peerInfo.ifidx = WIFI_IF_STA;   // obrigatório no ESP32
+    return esp_now_add_peer(&peerInfo) == ESP_OK;
+}
+
+// --------------------
+// Pareamento
+// --------------------
+volatile bool atribuido = false;
+
+void onAtribuicao(const esp_now_recv_info_t *info, const uint8_t *dados, int len) {
+    if (len < (int)sizeof(QuadroAtribuicao) || dados[0] != QUADRO_ATRIBUICAO) return;
+    QuadroAtribuicao q;
+    memcpy(&q, dados, sizeof(q));
+    if (q.id == ID_NENHUM) return;
+    aplicaAtribuicao(rtcState, q);
+    memcpy(rtcState.macRx, info->src_addr, 6);
+    atribuido = true;
+}
+
+// Anuncia TX_ID em broadcast até o receptor responder com o ID curto
+bool anuncia(uint8_t nSondas) {
+    QuadroAnuncio a = {};
+    a.tipo = QUADRO_ANUNCIO;
+    a.n_sondas = nSondas;
+    strncpy(a.nome, TX_ID, sizeof(a.nome) - 1);
+
+    if (!adicionaPeer(MAC_BROADCAST)) return false;
+    esp_now_register_recv_cb(onAtribuicao);
+    atribuido = false;
+    for (uint8_t t = 0; t < PAREAMENTO_TENTATIVAS && !atribuido; t++) {
+        esp_now_send(MAC_BROADCAST, (uint8_t*)&a, sizeof(a));
+        unsigned long inicio = millis();
+        while (!atribuido && millis() - inicio < PAREAMENTO_MS) delay(1);
+    }
+    esp_now_unregister_recv_cb();
+    esp_now_del_peer(MAC_BROADCAST);
+    return atribuido;
+}
+
+void dormir() {
+    Serial.printf("Dormindo por %lu segundos...\n", (unsigned long)(SEND_INTERVAL / 1000000ULL));
+
+    esp_sleep_enable_timer_wakeup(SEND_INTERVAL);
+    esp_deep_sleep_start();
+}
+
 // --------------------
 // Setup
 // --------------------
 void setup() {
     Serial.begin(115200);
+    uint16_t seq = iniciaDespertar(rtcState);
+    uint16_t fases[N_FASES] = {};   // deste despertar; só vai para rtcState.fases no fim do envio
+    Cronometro crono(fases);
+
+    // Busca OneWire só no heartbeat ou depois de uma sonda sumir; no resto, ROM IDs do cache
+    if (precisaBuscarSondas(rtcState)) {
+        uint8_t rom[MAX_SONDAS][8];
+        uint8_t encontradas = enumeraSondas(sensors, rom, MAX_SONDAS);
+        if (atualizaSondas(rtcState, rom, encontradas)) Serial.printf("Sondas encontradas: %u\n", encontradas);
+    }
+
+    // Leitura de todas as sondas antes de ligar o rádio (centésimos de °C, sem float)
+    int16_t temps[MAX_SONDAS];
+    uint8_t n = rtcState.nSondas;
+    if (n == 0) {
+        temps[0] = TEMP_DESCONECTADO_CC;   // sem sonda: envia -127.00 como antes
+        n = 1;
+    } else if (!lerSondas(sensors, rtcState.rom, n, temps) && sondaSumiu(rtcState, temps, n)) {
+        rtcState.refazerBusca = true;      // sonda sumiu: refaz a busca no próximo despertar
+    }
+    crono.marca(FASE_CONVERSAO);
+    char tempStr[8];
+    for (uint8_t s = 0; s < n; s++) {
+        formatCenti(tempStr, sizeof(tempStr), temps[s]);
+        Serial.printf("Sonda %u: %s°C\n", s + 1, tempStr);
+    }
+
+    uint8_t motivo;
+    if (!deveEnviar(rtcState, temps, n, motivo)) {
+        finalizaDespertar(rtcState, temps, n, false);
+        Serial.printf("Sem alteração (%u/%u)\n", rtcState.ciclosSemEnvio, HEARTBEAT);
+        dormir();
+    }
 
     WiFi.mode(WIFI_STA);
     WiFi.disconnect();
 
     if (esp_now_init() != ESP_OK) {
         Serial.println("Erro ao iniciar ESP-NOW");
-        return;
+        finalizaDespertar(rtcState, temps, n, false);
+        dormir();
     }
 
-    // Adiciona peer (receptor)
-    esp_now_peer_info_t peerInfo;
-    memset(&peerInfo, 0, sizeof(peerInfo));
-    memcpy(peerInfo.peer_addr, mac_rx, 6);
-    peerInfo.channel = 1;           // canal do receptor (confira no RX)
-    peerInfo.encrypt = false;
-    peerInfo.ifidx = WIFI_IF_STA;   // obrigatório no ESP32
+    // Sem ID, reanúncio periódico ou receptor mudo: pareia antes de enviar
+    if (precisaAnunciar(rtcState)) {
+        bool ok = anuncia(n);
+        registraAnuncio(rtcState, ok);
+        if (ok) Serial.printf("Pareado: ID %u\n", rtcState.idCurto);
+        else Serial.println("Sem resposta ao anúncio");
+        if (rtcState.idCurto == ID_NENHUM) {
+            finalizaDespertar(rtcState, temps, n, false);
+            dormir();
+        }
+    }
 
-    if (esp_now_add_peer(&peerInfo) != ESP_OK) {
+    // Adiciona peer (receptor)
+    if (!adicionaPeer(rtcState.macRx)) {
         Serial.println("Falha ao adicionar peer");
-        return;
+        finalizaDespertar(rtcState, temps, n, false);
+        dormir();
     }
+    esp_now_register_send_cb(onDataSent);
+    esp_now_register_recv_cb(onAtribuicao);   // resposta com limites editados no receptor
+    crono.marca(FASE_RADIO);
 
-    sensors.begin();
-    sensors.setResolution(12); // máxima precisão
-
-    // Leitura do sensor
     SensorData data = {};
-    strncpy(data.nome_tx, TX_ID, sizeof(data.nome_tx));
-    data.nome_tx[sizeof(data.nome_tx)-1] = '\0';
-
-    sensors.requestTemperatures();
-    float temp = sensors.getTempCByIndex(0);
-    temp = round(temp * 100.0) / 100.0;
-    data.temp = temp;
+    data.tipo = QUADRO_DADOS;
+    data.id = rtcState.idCurto;
+    data.seq = seq;
+    data.heartbeat = HEARTBEAT;
+    data.intervalo_s = (uint32_t)(SEND_INTERVAL / 1000000ULL);
+    data.motivo = motivo;
+    data.n_sondas = n;
+    data.resolucao = RESOLUCAO;
+    data.limites = assinaturaLimites(rtcState);
+    memcpy(data.fases, rtcState.fases, sizeof(data.fases));   // registro fechado do último despertar que transmitiu
+    memcpy(data.temp_cc, temps, n * sizeof(int16_t));
 
     // Envia para o RX
-    esp_err_t result = esp_now_send(mac_rx, (uint8_t*)&data, sizeof(data));
-    if (result == ESP_OK) {
-        Serial.printf("Enviado: ID=%s Temp=%.2f°C\n", data.nome_tx, data.temp);
+    statusEnvio = -1;
+    atribuido = false;
+    esp_err_t result = esp_now_send(rtcState.macRx, (uint8_t*)&data, tamanhoQuadro(n));
+    crono.marca(FASE_ENVIO);
+
+    // Espera o ACK da camada MAC: só ele confirma que o receptor ouviu
+    uint32_t inicioAck = micros();
+    while (result == ESP_OK && statusEnvio < 0 && micros() - inicioAck < ACK_TIMEOUT_US) delay(1);
+    // Com ACK, uma janela curta para a atribuição: só chega se os limites mudaram
+    unsigned long inicioLimites = millis();
+    while (statusEnvio == 1 && !atribuido && millis() - inicioLimites < LIMITES_MS) delay(1);
+    crono.marca(FASE_ACK);
+    if (atribuido) Serial.println("Limites atualizados pelo receptor");
+    memcpy(rtcState.fases, fases, sizeof(fases));   // fecha o registro: vai no próximo quadro
+
+    bool enviado = result == ESP_OK && statusEnvio == 1;
+    if (enviado) {
+        Serial.printf("Enviado: %s (ID %u) sondas=%u seq=%u motivo=%u\n", TX_ID, data.id, data.n_sondas, data.seq, data.motivo);
     } else {
         Serial.println("Erro ao enviar dados");
     }
+    registraEnvio(rtcState, enviado);
+    finalizaDespertar(rtcState, temps, n, enviado);
 
     // --------------------
-    // Light sleep até próxima leitura
+    // Deep sleep até próxima leitura
     // --------------------
-    Serial.printf("Dormindo por %.2f segundos...\n", (double)SEND_INTERVAL / 1e6);
-
-    esp_sleep_enable_timer_wakeup(SEND_INTERVAL);
-    esp_deep_sleep_start();
+    dormir();
 }
 
 // --------------------
@@ -2,172 +2,205 @@
 #define ESP8266_RX_H
 
     #include <Wire.h>
-    #include <RTClib.h>
-    #include <LittleFS.h>
     #include <ESP8266WebServer.h>
     #include <SD.h>
     #include <SPI.h>
 
-    #ifndef QTDE_TX
-        #define QTDE_TX 1
-    #endif
-    #ifndef TEMP_MIN
-        #define TEMP_MIN 5.0
-    #endif
-    #ifndef TEMP_MAX
-        #define TEMP_MAX 10.0
-    #endif
+    #define SD_CHUNK 2048   // ESP8266 tem pouca RAM para o buffer de cópia
+    #define PAGINA_ESTACOES 32   // estações por resposta do /estacoes
+    #include "politicas_arduino.h"
+    #include "log_rotativo.h"
+    #include "sincronia_log.h"
+    #include "espelho_sd.h"
+    #include "enviador.h"
 
     #define FLASH_BTN 0  // GPIO0 (botão FLASH)
     #define SD_CS_PIN 15 // GPIO15 (pino CS do SD)
 
-    // Lista de nomes a partir do PlatformIO.ini
-    #define LISTA_TX {NOME_TX1,NOME_TX2,NOME_TX3,NOME_TX4,NOME_TX5,NOME_TX6,NOME_TX7,NOME_TX8,NOME_TX9,NOME_TX10}
-
-    RTC_DS1307 rtc;
     ESP8266WebServer server(80);
     OneWire oneWire(ONEWIRE_PIN);
     DallasTemperature sensors(&oneWire);
+    LogRotativo arquivoLog;
+    EspelhoSD<decltype(SD), int> espelho(arquivoLog, SD, SD_CS_PIN, FILE_WRITE);   // FILE_WRITE faz append no SD do ESP8266
+    Enviador enviador(arquivoLog);
 
     // --------------------
-    // Estruturas de controle
+    // Políticas do núcleo (nucleo_receptor.h) no ESP8266
     // --------------------
-    struct StationState {
-        char nome[16];
-        bool lowAlert;
-        bool highAlert;
+    // Responde com o ID curto e os limites. A resposta a um quadro de dados
+    // nasce no callback do Wi-Fi, então tudo passa por uma fila curta e sai
+    // no loop(). Só um peer temporário por vez: o ESP-NOW tem poucos peers e
+    // o receptor só fala com o TX na atribuição.
+    #define RESPOSTAS_PENDENTES 4
+    struct RespostaPendente {
+        uint8_t mac[6];
+        QuadroAtribuicao quadro;
     };
-
-    SensorData stationData[QTDE_TX];          // Últimos dados recebidos
-    StationState stationStates[QTDE_TX];      // Estados de alerta por estação
-    bool receivedStation[QTDE_TX] = {false};  // Marca se cada estação já enviou
-    const char *expectedNames[10] = LISTA_TX;
-    unsigned long lastRecvTime = 0;
-    int receivedCount = 0;
-    bool waitingBlock = false; // indica se já iniciamos um bloco
-
-    // --------------------
-    // Funções auxiliares
-    // --------------------
-    String pad2(int value) {
-        return (value < 10 ? "0" : "") + String(value);
-    }
-
-    void writeLog(const String &entry) {
-        Serial.println(entry);
-        File logFile = LittleFS.open("/log.txt", "a");
-        if (logFile) {
-            logFile.println(entry);
-            logFile.close();
+    RespostaPendente respostas[RESPOSTAS_PENDENTES];
+    volatile uint8_t respostasIni = 0, respostasFim = 0;
+
+    struct RadioEsp8266 {
+        static bool responde(const uint8_t *mac, const uint8_t *buf, size_t len) {
+            uint8_t prox = (respostasFim + 1) % RESPOSTAS_PENDENTES;
+            if (prox == respostasIni || len > sizeof(QuadroAtribuicao)) return false;   // cheio: o TX tenta de novo
+            memcpy(respostas[respostasFim].mac, mac, 6);
+            memcpy(&respostas[respostasFim].quadro, buf, len);
+            respostasFim = prox;
+            return true;
         }
 
-        File sdFile = SD.open("/log.txt", FILE_WRITE);
-        if (sdFile) {
-            sdFile.println(entry);
-            sdFile.close();
+        static void enviaPendentes() {
+            static uint8_t ultimoPeer[6];
+            static bool temPeer = false;
+            while (respostasIni != respostasFim) {
+                RespostaPendente &r = respostas[respostasIni];
+                if (temPeer && memcmp(ultimoPeer, r.mac, 6) != 0) {
+                    esp_now_del_peer(ultimoPeer);
+                    temPeer = false;
+                }
+                if (!temPeer) {
+                    memcpy(ultimoPeer, r.mac, 6);
+                    temPeer = esp_now_add_peer(ultimoPeer, ESP_NOW_ROLE_COMBO, 1, NULL, 0) == 0;
+                }
+                esp_now_send(ultimoPeer, (uint8_t*)&r.quadro, sizeof(r.quadro));
+                respostasIni = (respostasIni + 1) % RESPOSTAS_PENDENTES;
+            }
         }
-    }
+    };
 
-    int getStationIndex(const char* nome) {
-    for (int i = 0; i < QTDE_TX; i++) {
-        if (strlen(stationStates[i].nome) == 0) continue; // ignora vazio
-        if (strcmp(stationStates[i].nome, nome) == 0) return i;
-    }
-    return -1;
-}
-
-    // Log da estação (com alerta)
-    void logStation(const char* nome_tx, float temp) {
-        int idx = getStationIndex(nome_tx);
-        if (idx == -1) return; // nome não cadastrado
-
-        String entry;
-        DateTime now = rtc.now();
-        entry += pad2(now.day()) + "/" + pad2(now.month()) + "/" + String(now.year()) + " ";
-        entry += pad2(now.hour()) + ":" + pad2(now.minute()) + ":" + pad2(now.second());
-        entry += " - Est: " + String(nome_tx) + " | Temp: " + String(temp, 2) + " \u00B0C";
-
-        if (temp < TEMP_MIN && !stationStates[idx].lowAlert) {
-            entry += " <<< ALERTA: abaixo de " + String(TEMP_MIN) + " \u00B0C!";
-            stationStates[idx].lowAlert = true;
-            stationStates[idx].highAlert = false;
-        } else if (temp > TEMP_MAX && !stationStates[idx].highAlert) {
-            entry += " <<< ALERTA: acima de " + String(TEMP_MAX) + " \u00B0C";
-            stationStates[idx].highAlert = true;
-            stationStates[idx].lowAlert = false;
-        } else if (temp >= TEMP_MIN && temp <= TEMP_MAX) {
-            if (stationStates[idx].lowAlert || stationStates[idx].highAlert)
-                entry += " <<< NORMALIZADO";
-            stationStates[idx].lowAlert = false;
-            stationStates[idx].highAlert = false;
+    // Grava direto no LittleFS; o SD é espelhado depois, em espelho.tick()
+    struct ArmazenamentoEsp8266 : ArquivosLittleFS {
+        static void grava(const char *linha) {
+            Serial.println(linha);
+            File logFile = arquivoLog.abre();
+            if (logFile) {
+                logFile.println(linha);
+                arquivoLog.fecha(logFile);
+            }
         }
+    };
 
-        writeLog(entry);
-    }
-
-    // Log do ambiente (abre o bloco)
-    void logAmbient() {
-        sensors.requestTemperatures();
-        float ambientTemp = sensors.getTempCByIndex(0);
-
-        DateTime now = rtc.now();
-        String entry = pad2(now.day()) + "/" + pad2(now.month()) + "/" + String(now.year()) + " ";
-        entry += pad2(now.hour()) + ":" + pad2(now.minute()) + ":" + pad2(now.second());
-        entry += " - Ambiente: " + String(ambientTemp, 2) + " \u00B0C";
+    NucleoReceptor<RadioEsp8266, RelogioRtc, ArmazenamentoEsp8266, WebString> nucleo;
 
-        writeLog(entry);
+    // Anúncios chegam no callback do Wi-Fi; registro e resposta ficam para o loop()
+    #define ANUNCIOS_PENDENTES 4
+    struct AnuncioPendente {
+        uint8_t mac[6];
+        QuadroAnuncio quadro;
+    };
+    AnuncioPendente anuncios[ANUNCIOS_PENDENTES];
+    volatile uint8_t anunciosIni = 0, anunciosFim = 0;
 
-        waitingBlock = true;
-        receivedCount = 0;
-        for (int i = 0; i < QTDE_TX; i++) receivedStation[i] = false;
-    }
+    unsigned long ultimaVerificacao = 0;   // último verificaSilencio()
+    unsigned long ultimoAmbiente = 0;
+    bool ambienteLido = false;             // a primeira leitura sai logo no boot
 
-    // Fecha bloco e registra faltantes
-    void closeBlock() {
-        for (int i = 0; i < QTDE_TX; i++) {
-            if (!receivedStation[i] && strlen(expectedNames[i]) > 0) {
-                writeLog(String("Estacao faltante: ") + expectedNames[i]);
-            }
+    // --------------------
+    // Callback ESP-NOW
+    // --------------------
+    void onDataRecv(uint8_t *mac, uint8_t *incomingData, uint8_t len) {
+        if (anuncioValido(incomingData, len)) {
+            uint8_t prox = (anunciosFim + 1) % ANUNCIOS_PENDENTES;
+            if (prox == anunciosIni) return;   // cheio: o TX tenta de novo
+            memcpy(anuncios[anunciosFim].mac, mac, 6);
+            memcpy(&anuncios[anunciosFim].quadro, incomingData, sizeof(QuadroAnuncio));
+            anunciosFim = prox;
+            return;
         }
-        writeLog("--------------------------------------");
+        nucleo.processa(mac, incomingData, len);
+    }
 
-        waitingBlock = false;
-        receivedCount = 0;
+    // --------------------
+    // Rota web /energia: último perfil de cada estação (fases em 100 µs), para tools/energia.cpp
+    // --------------------
+    void handleEnergia() {
+        String csv;
+        nucleo.energiaCsv(csv);
+        server.send(200, "text/csv", csv);
     }
 
     // --------------------
-    // Callback ESP-NOW
+    // Rota web /estacoes
     // --------------------
-    void onDataRecv(uint8_t *mac, uint8_t *incomingData, uint8_t len) {
-        if (len != sizeof(SensorData)) return;
-        SensorData data;
-        memcpy(&data, incomingData, sizeof(SensorData));
-
-        lastRecvTime = millis();
-
-        // Evita duplicados
-        int idx = getStationIndex(data.nome_tx);
-        if (idx != -1 && !receivedStation[idx]) {
-            stationData[idx] = data;
-            receivedStation[idx] = true;
-            receivedCount++;
-            logStation(data.nome_tx, data.temp);
-        }
+    // GET ?de=0: página do registro em JSON (PAGINA_ESTACOES por vez)
+    void handleEstacoes() {
+        String json;
+        nucleo.estacoesJson(json, server.hasArg("de") ? server.arg("de").toInt() : 0);
+        server.send(200, "application/json", json);
+    }
+
+    // POST id=3&nome=Geladeira2&min=2.5&max=8 (com sonda=2, só aquela sonda):
+    // vale na hora, sem reiniciar
+    void handleEditaEstacao() {
+        String id = server.arg("id"), sonda = server.arg("sonda"), nome = server.arg("nome");
+        String txtMin = server.arg("min"), txtMax = server.arg("max");
+        const char *msg;
+        int codigo = nucleo.editaEstacao(server.hasArg("id") ? id.c_str() : nullptr,
+                                         server.hasArg("sonda") ? sonda.c_str() : nullptr,
+                                         server.hasArg("nome") ? nome.c_str() : nullptr,
+                                         server.hasArg("min") ? txtMin.c_str() : nullptr,
+                                         server.hasArg("max") ? txtMax.c_str() : nullptr, msg);
+        server.send(codigo, "text/plain", msg);
     }
 
     // --------------------
     // Rota web /log
     // --------------------
+    // Log inteiro, faixa (Range), condicional (If-None-Match) ou incremental
+    // (?since=cursor); posições e cursores são absolutos (sincronia_log.h)
     void handleLog() {
-        if (LittleFS.exists("/log.txt")) {
-            File logFile = LittleFS.open("/log.txt", "r");
-            if (logFile) {
-                server.streamFile(logFile, "text/plain; charset=UTF-8");
-                logFile.close();
+        uint32_t sessao = arquivoLog.sessao(), inicio = arquivoLog.inicio(), fim = arquivoLog.fim();
+        bool temSince = server.hasArg("since");
+        if (fim == inicio && !temSince) {
+            File sdFile;
+            if (espelho.estaMontado() && SD.exists(LOG_PATH)) sdFile = SD.open(LOG_PATH, FILE_READ);
+            if (sdFile) {
+                server.streamFile(sdFile, "text/plain; charset=UTF-8");
+                sdFile.close();
+            } else {
+                server.send(200, "text/plain", "Nenhum log encontrado.");
             }
-        } else {
-            server.send(200, "text/plain", "Nenhum log encontrado.");
+            return;
+        }
+
+        String since = server.arg("since"), range = server.header("Range"), inm = server.header("If-None-Match");
+        RespostaLog r = resolvePedidoLog(temSince ? since.c_str() : nullptr,
+                                         server.hasHeader("Range") ? range.c_str() : nullptr,
+                                         server.hasHeader("If-None-Match") ? inm.c_str() : nullptr,
+                                         sessao, inicio, fim);
+
+        char etag[LOG_CURSOR_MAX + 2], cursor[LOG_CURSOR_MAX];
+        formataEtag(etag, sizeof(etag), sessao, fim);
+        formataCursor(cursor, sizeof(cursor), sessao, r.ate);
+        server.sendHeader("ETag", etag);
+        server.sendHeader("Accept-Ranges", "bytes");
+        server.sendHeader("X-Log-Cursor", cursor);
+        server.sendHeader("X-Log-Inicio", String(inicio));
+        if (r.reinicio) server.sendHeader("X-Log-Reinicio", "1");
+        if (r.lacuna) server.sendHeader("X-Log-Lacuna", String(r.lacuna));
+        if (r.codigo == 206) server.sendHeader("Content-Range", "bytes " + String(r.de) + "-" + String(r.ate - 1) + "/" + String(fim));
+        if (r.codigo == 416) server.sendHeader("Content-Range", "bytes */" + String(fim));
+
+        if (r.codigo != 200 && r.codigo != 206) {
+            server.send(r.codigo);
+            return;
         }
+        server.setContentLength(r.ate - r.de);
+        server.send(r.codigo, "text/plain; charset=UTF-8", "");
+        // sendContent() cede ao Wi-Fi e o callback do ESP-NOW grava no meio:
+        // a rotação fica adiada até o fim, e se vier mesmo assim a conexão cai
+        // em vez de terminar num corpo mais curto que o anunciado
+        static uint8_t buf[1024];
+        uint32_t pos = r.de;
+        arquivoLog.fixa();
+        while (pos < r.ate) {
+            size_t n = arquivoLog.le(pos, buf, min((uint32_t)sizeof(buf), r.ate - pos));
+            if (n == 0) break;
+            server.sendContent((const char*)buf, n);
+            pos += n;
+        }
+        arquivoLog.solta();
+        if (pos < r.ate) server.client().stop();
     }
 
     // --------------------
@@ -187,27 +220,20 @@
             return;
         }
 
-        if (!SD.begin(SD_CS_PIN)) {
-            Serial.println("Falha ao inicializar o cartão SD.");
-        } else {
-            Serial.println("Cartão SD pronto.");
-        }
+        arquivoLog.begin();
+        espelho.begin();
 
         sensors.begin();
         sensors.setResolution(12);
 
-        // Inicializa nomes e estados
-        for (int i = 0; i < QTDE_TX; i++) {
-            strncpy(stationStates[i].nome, expectedNames[i], sizeof(stationStates[i].nome));
-            stationStates[i].lowAlert = false;
-            stationStates[i].highAlert = false;
-        }
+        Serial.printf("Registro: %u estações\n", nucleo.begin());   // pareadas em boots anteriores
 
         WiFi.mode(WIFI_AP_STA);
         WiFi.softAP("RECEPTOR", "12345678");
         WiFi.disconnect();
         Serial.print("AP iniciado. Conecte-se em: ");
         Serial.println(WiFi.softAPIP());
+        enviador.begin();   // STA no coletor, se COLETOR_HOST estiver definido
 
         server.on("/", []() {
             String html = "<h1>Servidor ESP8266</h1>";
@@ -216,6 +242,11 @@
             server.send(200, "text/html; charset=utf-8 ", html);
         });
         server.on("/log", handleLog);
+        server.on("/energia", handleEnergia);
+        server.on("/estacoes", HTTP_GET, handleEstacoes);
+        server.on("/estacoes", HTTP_POST, handleEditaEstacao);
+        const char *cabecalhos[] = { "Range", "If-None-Match" };
+        server.collectHeaders(cabecalhos, 2);
         server.begin();
 
         if (esp_now_init() != 0) {
@@ -229,27 +260,42 @@
     }
 
     void loop() {
+        RadioEsp8266::enviaPendentes();   // antes do resto: o TX espera só LIMITES_MS
         server.handleClient();
 
         // Botão FLASH para zerar log
         if (digitalRead(FLASH_BTN) == LOW) {
             Serial.println("Botão FLASH pressionado: log zerado.");
-            if (LittleFS.exists("/log.txt")) LittleFS.remove("/log.txt");
-            if (SD.exists("/log.txt")) SD.remove("/log.txt");
+            arquivoLog.clear();
+            espelho.clear();
+            enviador.clear();
             delay(500); // debounce
         }
 
-        // Se não estamos aguardando bloco, inicia novo com ambiente
-        if (!waitingBlock) {
-            logAmbient();
-            lastRecvTime = millis();
+        // Pareamento de transmissores novos
+        while (anunciosIni != anunciosFim) {
+            nucleo.processaAnuncio(anuncios[anunciosIni].mac, anuncios[anunciosIni].quadro);
+            anunciosIni = (anunciosIni + 1) % ANUNCIOS_PENDENTES;
+        }
+        RadioEsp8266::enviaPendentes();
+        nucleo.registro.persiste();   // fora do callback do Wi-Fi, que só marca
+
+        // Cópia do log para o SD e para o coletor em segundo plano
+        espelho.tick();
+        enviador.tick();
+
+        // Temperatura ambiente a cada AMBIENTE_MS
+        if (!ambienteLido || millis() - ultimoAmbiente >= AMBIENTE_MS) {
+            sensors.requestTemperatures();
+            nucleo.amostraAmbiente(lerCentiPorIndice(sensors, 0));
+            ultimoAmbiente = millis();
+            ambienteLido = true;
         }
 
-        // Fecha bloco quando todas estações chegaram ou timeout
-        if (waitingBlock) {
-            if (receivedCount >= QTDE_TX || millis() - lastRecvTime > TIMEOUT_MS) {
-                closeBlock();
-            }
+        // Estações caladas além da janela do heartbeat
+        if (millis() - ultimaVerificacao >= SILENCIO_MS) {
+            nucleo.verificaSilencio();
+            ultimaVerificacao = millis();
         }
     }
 
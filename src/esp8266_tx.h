@@ -1,16 +1,14 @@
 #ifndef ESP8266_TX_H
 #define ESP8266_TX_H
 
+    #include "politica_envio.h"
+
     // Configura DS18B20
     OneWire oneWire(ONEWIRE_PIN);
     DallasTemperature sensors(&oneWire);
 
-    // MAC do receptor (ajustar conforme sua rede)
-    #ifndef MAC_RX
-    #define MAC_RX {MAC_RX_0, MAC_RX_1, MAC_RX_2, MAC_RX_3, MAC_RX_4, MAC_RX_5}  // fallback
-    #endif
-
-    uint8_t mac_rx[6] = MAC_RX;
+    // O MAC do receptor vem do pareamento (guardado em rtcState.macRx)
+    uint8_t MAC_BROADCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
     // Conversões de tempo
     uint64_t secondsToUs(uint32_t s) { return static_cast<uint64_t>(s) * 1000000ULL; }
@@ -22,50 +20,171 @@
     #elif INTERVALO == MINUTO || INTERVALO == MINUTOS
     const uint64_t SEND_INTERVAL = minutesToUs(TEMPO);
     #elif INTERVALO == HORA || INTERVALO == HORAS
-    const uint64_t INTERVALO = hoursToUs(TEMPO);
+    const uint64_t SEND_INTERVAL = hoursToUs(TEMPO);
     #else
     #error "INTERVALO inválido! Use SEGUNDOS, MINUTOS ou HORAS."
     #endif
 
+    // Estado da política de envio (memória RTC de usuário, sobrevive ao deep sleep)
+    TxRtcState rtcState;
+
+    // Resultado do último envio: -1 aguardando, 0 falhou, 1 ACK recebido
+    volatile int8_t statusEnvio = -1;
+
+    void onDataSent(uint8_t *mac, uint8_t status) {
+        statusEnvio = (status == 0) ? 1 : 0;
+    }
+
+    // --------------------
+    // Pareamento
+    // --------------------
+    volatile bool atribuido = false;
+
+    void onAtribuicao(uint8_t *mac, uint8_t *dados, uint8_t len) {
+        if (len < sizeof(QuadroAtribuicao) || dados[0] != QUADRO_ATRIBUICAO) return;
+        QuadroAtribuicao q;
+        memcpy(&q, dados, sizeof(q));
+        if (q.id == ID_NENHUM) return;
+        aplicaAtribuicao(rtcState, q);
+        memcpy(rtcState.macRx, mac, 6);
+        atribuido = true;
+    }
+
+    // Anuncia TX_ID em broadcast até o receptor responder com o ID curto
+    bool anuncia(uint8_t nSondas) {
+        QuadroAnuncio a = {};
+        a.tipo = QUADRO_ANUNCIO;
+        a.n_sondas = nSondas;
+        strncpy(a.nome, TX_ID, sizeof(a.nome) - 1);
+
+        esp_now_add_peer(MAC_BROADCAST, ESP_NOW_ROLE_COMBO, 1, NULL, 0);
+        esp_now_register_recv_cb(onAtribuicao);
+        atribuido = false;
+        for (uint8_t t = 0; t < PAREAMENTO_TENTATIVAS && !atribuido; t++) {
+            esp_now_send(MAC_BROADCAST, (uint8_t*)&a, sizeof(a));
+            unsigned long inicio = millis();
+            while (!atribuido && millis() - inicio < PAREAMENTO_MS) delay(1);
+        }
+        esp_now_unregister_recv_cb();
+        esp_now_del_peer(MAC_BROADCAST);
+        return atribuido;
+    }
+
+    void dormir() {
+        ESP.rtcUserMemoryWrite(0, (uint32_t*)&rtcState, sizeof(rtcState));
+
+        // Deep sleep até próxima leitura
+        Serial.printf("Dormindo por %lu segundos...\n", (unsigned long)(SEND_INTERVAL / 1000000ULL));
+
+        WiFi.forceSleepBegin(); // WiFi em sleep
+        delay(1);
+        system_deep_sleep(SEND_INTERVAL); // acorda pelo timer
+        delay(100);                       // aguarda o deep sleep efetivar
+    }
+
     void setup() {
         Serial.begin(115200);
 
-        sensors.begin();
-        sensors.setResolution(12);
-        sensors.requestTemperatures();
-        float temp = sensors.getTempCByIndex(0);
+        ESP.rtcUserMemoryRead(0, (uint32_t*)&rtcState, sizeof(rtcState));
+        uint16_t seq = iniciaDespertar(rtcState);
+        uint16_t fases[N_FASES] = {};   // deste despertar; só vai para rtcState.fases no fim do envio
+        Cronometro crono(fases);
+
+        // Busca OneWire só no heartbeat ou depois de uma sonda sumir; no resto, ROM IDs do cache
+        if (precisaBuscarSondas(rtcState)) {
+            uint8_t rom[MAX_SONDAS][8];
+            uint8_t encontradas = enumeraSondas(sensors, rom, MAX_SONDAS);
+            if (atualizaSondas(rtcState, rom, encontradas)) Serial.printf("Sondas encontradas: %u\n", encontradas);
+        }
+
+        // Leitura de todas as sondas antes de ligar o rádio (centésimos de °C, sem float)
+        int16_t temps[MAX_SONDAS];
+        uint8_t n = rtcState.nSondas;
+        if (n == 0) {
+            temps[0] = TEMP_DESCONECTADO_CC;   // sem sonda: envia -127.00 como antes
+            n = 1;
+        } else if (!lerSondas(sensors, rtcState.rom, n, temps) && sondaSumiu(rtcState, temps, n)) {
+            rtcState.refazerBusca = true;      // sonda sumiu: refaz a busca no próximo despertar
+        }
+        crono.marca(FASE_CONVERSAO);
+        char tempStr[8];
+        for (uint8_t s = 0; s < n; s++) {
+            formatCenti(tempStr, sizeof(tempStr), temps[s]);
+            Serial.printf("Sonda %u: %s°C\n", s + 1, tempStr);
+        }
+
+        uint8_t motivo;
+        if (!deveEnviar(rtcState, temps, n, motivo)) {
+            finalizaDespertar(rtcState, temps, n, false);
+            Serial.printf("Sem alteração (%u/%u)\n", rtcState.ciclosSemEnvio, HEARTBEAT);
+            dormir();
+            return;
+        }
 
         WiFi.mode(WIFI_AP_STA);
         WiFi.disconnect();
 
         if (esp_now_init() != 0) {
             Serial.println("Erro ao iniciar ESP-NOW");
+            finalizaDespertar(rtcState, temps, n, false);
+            dormir();
             return;
         }
 
-        esp_now_set_self_role(ESP_NOW_ROLE_CONTROLLER);
-        esp_now_add_peer(mac_rx, ESP_NOW_ROLE_SLAVE, 1, NULL, 0);
-
-        SensorData data = {};
-        strncpy(data.nome_tx, TX_ID, sizeof(data.nome_tx));
-        data.nome_tx[sizeof(data.nome_tx)-1] = '\0';
-
-        // Faz a leitura do sensor
-        sensors.requestTemperatures();
-        temp = sensors.getTempCByIndex(0);
-        temp = round(temp * 100.0) / 100.0;
-
-        data.temp = temp;
-        
-        esp_now_send(mac_rx, (uint8_t*)&data, sizeof(data));
-        Serial.printf("Enviado: ID=%s Temp=%.2f°C\n", data.nome_tx, data.temp);
+        esp_now_set_self_role(ESP_NOW_ROLE_COMBO);   // COMBO: recebe a atribuição no pareamento
+
+        // Sem ID, reanúncio periódico ou receptor mudo: pareia antes de enviar
+        if (precisaAnunciar(rtcState)) {
+            bool ok = anuncia(n);
+            registraAnuncio(rtcState, ok);
+            if (ok) Serial.printf("Pareado: ID %u\n", rtcState.idCurto);
+            else Serial.println("Sem resposta ao anúncio");
+            if (rtcState.idCurto == ID_NENHUM) {
+                finalizaDespertar(rtcState, temps, n, false);
+                dormir();
+                return;
+            }
+        }
 
-        // Light sleep até próxima leitura
-        Serial.printf("Dormindo por %.2f segundos...\n", (double)SEND_INTERVAL / 1e6);
+        esp_now_add_peer(rtcState.macRx, ESP_NOW_ROLE_SLAVE, 1, NULL, 0);
+        esp_now_register_send_cb(onDataSent);
+        esp_now_register_recv_cb(onAtribuicao);   // resposta com limites editados no receptor
+        crono.marca(FASE_RADIO);
 
-        WiFi.forceSleepBegin(); // WiFi em sleep
-        delay(1);
-        system_deep_sleep(SEND_INTERVAL); // acorda pelo timer
+        SensorData data = {};
+        data.tipo = QUADRO_DADOS;
+        data.id = rtcState.idCurto;
+        data.seq = seq;
+        data.heartbeat = HEARTBEAT;
+        data.intervalo_s = (uint32_t)(SEND_INTERVAL / 1000000ULL);
+        data.motivo = motivo;
+        data.n_sondas = n;
+        data.resolucao = RESOLUCAO;
+        data.limites = assinaturaLimites(rtcState);
+        memcpy(data.fases, rtcState.fases, sizeof(data.fases));   // registro fechado do último despertar que transmitiu
+        memcpy(data.temp_cc, temps, n * sizeof(int16_t));
+
+        statusEnvio = -1;
+        atribuido = false;
+        bool enviado = esp_now_send(rtcState.macRx, (uint8_t*)&data, tamanhoQuadro(n)) == 0;
+        crono.marca(FASE_ENVIO);
+
+        // Espera o ACK da camada MAC: só ele confirma que o receptor ouviu
+        uint32_t inicioAck = micros();
+        while (enviado && statusEnvio < 0 && micros() - inicioAck < ACK_TIMEOUT_US) delay(1);
+        // Com ACK, uma janela curta para a atribuição: só chega se os limites mudaram
+        unsigned long inicioLimites = millis();
+        while (statusEnvio == 1 && !atribuido && millis() - inicioLimites < LIMITES_MS) delay(1);
+        crono.marca(FASE_ACK);
+        if (atribuido) Serial.println("Limites atualizados pelo receptor");
+        memcpy(rtcState.fases, fases, sizeof(fases));   // fecha o registro: vai no próximo quadro
+
+        enviado = enviado && statusEnvio == 1;
+        Serial.printf("%s: %s (ID %u) sondas=%u seq=%u motivo=%u\n", enviado ? "Enviado" : "Sem ACK", TX_ID, data.id, data.n_sondas, data.seq, data.motivo);
+        registraEnvio(rtcState, enviado);
+        finalizaDespertar(rtcState, temps, n, enviado);
+
+        dormir();
     }
 
     void loop() {
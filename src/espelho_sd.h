@@ -0,0 +1,242 @@
+#ifndef ESPELHO_SD_H
+#define ESPELHO_SD_H
+
+// --------------------
+// Espelho assíncrono do log no cartão SD
+// --------------------
+// O log principal fica só no LittleFS; a gravação do log nunca toca no SD.
+// O cartão é uma cópia atrasada e completa da sessão: o /log.txt do SD não
+// rotaciona, então a posição absoluta do log (log_rotativo.h) é também o
+// tamanho do arquivo no cartão. A marca d'água (hwm) diz até onde já foi
+// copiado, e tick() (chamado no loop) copia o que falta em blocos grandes
+// alinhados a setores de 512 bytes. Se a rotação descartar um trecho antes
+// da cópia, o cartão recebe no lugar uma linha de lacuna com exatamente o
+// mesmo tamanho, para o tamanho do arquivo continuar igual à posição
+// absoluta. Cartão retirado e reinserido é detectado pelo pino CD
+// (SD_CD_PIN) ou por sondagem periódica, e a cópia retoma de onde parou.
+//
+// A marca d'água e o cartão levam a sessão do log: /log.sessao no cartão
+// diz de qual sessão é o /log.txt dele. Cartão de outra sessão, de outro
+// receptor ou limpo fora do slot não serve de prefixo: o log dele é guardado
+// como /log_<sessao>.txt e a cópia recomeça do zero.
+
+#include "log_rotativo.h"
+
+#ifndef SD_CHUNK
+#define SD_CHUNK 4096          // bytes por escrita no SD (múltiplo de 512)
+#endif
+#ifndef SD_PROBE_MS
+#define SD_PROBE_MS 5000       // intervalo de sondagem sem pino CD
+#endif
+#ifndef SD_FLUSH_MS
+#define SD_FLUSH_MS 10000      // espera máxima para copiar um bloco incompleto
+#endif
+
+#define SD_SETOR 512
+#define HWM_PATH "/sd_hwm"              // no LittleFS: sessão e marca d'água
+#define SD_SESSAO_PATH "/log.sessao"    // no cartão: sessão do /log.txt copiado
+
+template <typename SDClassT, typename ModoT>
+class EspelhoSD {
+public:
+    EspelhoSD(LogRotativo &log, SDClassT &sd, uint8_t csPin, ModoT modoAppend)
+        : log(log), sd(sd), csPin(csPin), modoAppend(modoAppend) {}
+
+    void begin() {
+#ifdef SD_CD_PIN
+        pinMode(SD_CD_PIN, INPUT_PULLUP);
+#endif
+        leHwm();
+        if (monta()) Serial.println("Cartão SD pronto.");
+        else Serial.println("Falha ao inicializar o cartão SD.");
+    }
+
+    // Passo da cópia em segundo plano: no máximo uma escrita de SD_CHUNK bytes
+    void tick() {
+        unsigned long now = millis();
+        if (!montado) {
+            if (now - ultimaSondagem < SD_PROBE_MS) return;
+            ultimaSondagem = now;
+            if (!cartaoPresente() || !monta()) return;
+            Serial.printf("Cartão SD inserido: retomando cópia em %lu bytes\n", (unsigned long)hwm);
+        }
+#ifdef SD_CD_PIN
+        if (!cartaoPresente()) { desmonta(); return; }
+#endif
+        uint32_t total = log.fim();
+        if (log.sessao() != sessao || total < hwm) clear();   // log principal foi zerado por fora
+        if (hwm < log.inicio()) {
+            // Cartão ficou fora mais que duas rotações: o trecho do meio se perdeu
+            preencheLacuna(log.inicio());
+            return;
+        }
+        uint32_t pendente = total - hwm;
+        if (pendente == 0) { ultimaCopia = now; return; }
+
+        // Só escreve bloco cheio, a não ser que o resto esteja parado há SD_FLUSH_MS
+        uint32_t len = SD_CHUNK - (hwm % SD_SETOR);
+        if (pendente < len) {
+            if (now - ultimaCopia < SD_FLUSH_MS) return;
+            len = pendente;
+        }
+        if (copia(len)) {
+            ultimaCopia = now;
+            if (hwm == total) salvaHwm();
+        }
+    }
+
+    // Zera o log do SD junto com o principal (a sessão nova vai para o cartão)
+    void clear() {
+        hwm = 0;
+        sessao = log.sessao();
+        salvaHwm();
+        if (!montado) return;
+        if (sd.exists(LOG_PATH)) sd.remove(LOG_PATH);
+        if (!gravaSessaoCartao()) desmonta();
+    }
+
+    bool estaMontado() const { return montado; }
+    uint32_t marca() const { return hwm; }
+
+private:
+    LogRotativo &log;
+    SDClassT &sd;
+    uint8_t csPin;
+    ModoT modoAppend;
+    bool montado = false;
+    uint32_t hwm = 0;
+    uint32_t sessao = 0;               // sessão do log a que hwm se refere
+    uint32_t lacunaIni = UINT32_MAX;   // início da lacuna em preenchimento
+    unsigned long ultimaSondagem = 0;
+    unsigned long ultimaCopia = 0;
+    uint8_t buf[SD_CHUNK];
+
+    bool cartaoPresente() {
+#ifdef SD_CD_PIN
+        return digitalRead(SD_CD_PIN) == LOW;
+#else
+        return true;   // sem pino CD: a sondagem descobre pelo SD.begin()
+#endif
+    }
+
+    // Monta o cartão e reconcilia a marca d'água com o que está nele. Só um
+    // cartão da sessão atual, e não maior que o log, vale como prefixo.
+    bool monta() {
+        if (!sd.begin(csPin)) return false;
+        montado = true;
+        uint32_t doCartao = 0, noCartao = 0;
+        bool temSessao = leSessaoCartao(doCartao);
+        if (sd.exists(LOG_PATH)) {
+            File f = sd.open(LOG_PATH);
+            if (f) { noCartao = f.size(); f.close(); }
+        }
+        if (!temSessao || doCartao != log.sessao() || noCartao > log.fim()) {
+            if (sd.exists(LOG_PATH)) guardaLogAntigo(temSessao ? doCartao : 0);
+            noCartao = 0;
+            if (!gravaSessaoCartao()) { desmonta(); return false; }
+        }
+        if (noCartao != hwm || sessao != log.sessao()) {
+            Serial.printf("SD: marca %lu, cartão com %lu bytes\n", (unsigned long)hwm, (unsigned long)noCartao);
+            hwm = noCartao;
+            sessao = log.sessao();
+            salvaHwm();
+        }
+        return true;
+    }
+
+    // Log de outra sessão sai do caminho (apagado só se não der para renomear)
+    void guardaLogAntigo(uint32_t outra) {
+        char nome[24];
+        snprintf(nome, sizeof(nome), "/log_%08lx.txt", (unsigned long)outra);
+        if (sd.exists(nome)) sd.remove(nome);
+        if (!sd.rename(LOG_PATH, nome)) sd.remove(LOG_PATH);
+        Serial.printf("SD: log de outra sessão guardado em %s\n", nome);
+    }
+
+    bool leSessaoCartao(uint32_t &s) {
+        File f = sd.open(SD_SESSAO_PATH);
+        if (!f) return false;
+        char txt[12] = {};
+        f.read((uint8_t*)txt, sizeof(txt) - 1);
+        f.close();
+        char *fim;
+        s = strtoul(txt, &fim, 16);
+        return fim != txt;
+    }
+
+    // Sem modo de truncar comum às duas placas: apaga e cria em append
+    bool gravaSessaoCartao() {
+        if (sd.exists(SD_SESSAO_PATH)) sd.remove(SD_SESSAO_PATH);
+        File f = sd.open(SD_SESSAO_PATH, modoAppend);
+        if (!f) return false;
+        char txt[12];
+        int n = snprintf(txt, sizeof(txt), "%08lx\n", (unsigned long)log.sessao());
+        bool ok = f.write((const uint8_t*)txt, n) == (size_t)n;
+        f.close();
+        return ok;
+    }
+
+    void desmonta() {
+        if (!montado) return;
+        sd.end();
+        montado = false;
+        Serial.println("Cartão SD removido: cópia suspensa.");
+    }
+
+    bool copia(uint32_t len) {
+        size_t lido = log.le(hwm, buf, len);   // curto na divisa dos segmentos
+        if (lido == 0) return false;
+        return acrescenta(lido);
+    }
+
+    // Um passo (até SD_CHUNK bytes) do trecho [hwm, ate) descartado pela
+    // rotação: "\n", o aviso, espaços e "\n" no último byte, para a próxima
+    // linha copiada começar limpa e as posições seguirem valendo
+    void preencheLacuna(uint32_t ate) {
+        if (lacunaIni == UINT32_MAX || lacunaIni > hwm) {
+            lacunaIni = hwm;
+            Serial.printf("SD: %lu bytes descartados pela rotação antes da cópia\n", (unsigned long)(ate - hwm));
+        }
+        char aviso[64];
+        int nAviso = snprintf(aviso, sizeof(aviso), "*** LACUNA: %lu bytes descartados pela rotacao ***", (unsigned long)(ate - lacunaIni));
+        uint32_t len = ate - hwm < SD_CHUNK ? ate - hwm : SD_CHUNK;
+        for (uint32_t i = 0; i < len; i++) {
+            uint32_t p = hwm + i;
+            if (p == lacunaIni || p == ate - 1) buf[i] = '\n';
+            else if (p - lacunaIni - 1 < (uint32_t)nAviso) buf[i] = aviso[p - lacunaIni - 1];
+            else buf[i] = ' ';
+        }
+        if (acrescenta(len) && hwm == ate) {
+            lacunaIni = UINT32_MAX;
+            salvaHwm();
+        }
+    }
+
+    bool acrescenta(size_t len) {
+        File destino = sd.open(LOG_PATH, modoAppend);
+        if (!destino) { desmonta(); return false; }
+        size_t escrito = destino.write(buf, len);
+        destino.close();
+        if (escrito != len) { desmonta(); return false; }
+
+        hwm += escrito;
+        return true;
+    }
+
+    // Marca de outra sessão (ou ausente) vale 0: monta() confere com o cartão
+    void leHwm() {
+        uint32_t v[2] = {0, 0};   // sessão, marca
+        File f = LittleFS.open(HWM_PATH, "r");
+        if (f) { f.read((uint8_t*)v, sizeof(v)); f.close(); }
+        sessao = log.sessao();
+        hwm = v[0] == sessao ? v[1] : 0;
+    }
+
+    void salvaHwm() {
+        uint32_t v[2] = { sessao, hwm };
+        File f = LittleFS.open(HWM_PATH, "w");
+        if (f) { f.write((const uint8_t*)v, sizeof(v)); f.close(); }
+    }
+};
+
+#endif // ESPELHO_SD_H
@@ -0,0 +1,153 @@
+#ifndef LOG_ROTATIVO_H
+#define LOG_ROTATIVO_H
+
+// --------------------
+// Log no LittleFS com rotação e posições absolutas
+// --------------------
+// O log é /log.txt (segmento atual) mais /log.1 (anterior). Quando o atual
+// passa de LOG_MAX_BYTES ele vira /log.1 e o /log.1 antigo é descartado.
+// Quem lê (web, espelho SD, coletor) usa posições absolutas na sessão:
+// /log.base guarda a posição do byte 0 de cada segmento, então a rotação não
+// muda o significado de nenhuma posição. Zerar o log abre uma sessão nova.
+//
+// Gravação sempre por abre()/fecha(): os segmentos terminam em linha inteira
+// e fim() só avança depois do close, então quem lê até fim() nunca pega uma
+// linha pela metade. Uma leitura longa (resposta do /log) chama fixa()/solta()
+// em volta: enquanto houver alguma, a rotação espera, até o segmento atual
+// chegar a LOG_MAX_BYTES a mais; passado isso rotaciona mesmo e le() devolve 0.
+
+#include <LittleFS.h>
+
+#ifndef LOG_MAX_BYTES
+#define LOG_MAX_BYTES 262144UL   // tamanho do segmento atual antes de rotacionar
+#endif
+
+#define LOG_PATH "/log.txt"
+#define LOG_ANTERIOR_PATH "/log.1"
+#define LOG_BASE_PATH "/log.base"
+
+class LogRotativo {
+public:
+    void begin() {
+#ifdef ESP32
+        trava = xSemaphoreCreateMutex();
+#endif
+        File f = LittleFS.open(LOG_BASE_PATH, "r");
+        bool ok = f && f.read((uint8_t*)&meta, sizeof(meta)) == sizeof(meta);
+        if (f) f.close();
+        if (!ok) {
+            clear();
+            return;
+        }
+        tamAtual = tamanhoDe(LOG_PATH);
+        if (!LittleFS.exists(LOG_ANTERIOR_PATH)) meta.baseAnterior = meta.base;
+        Serial.printf("Log: sessão %08lx, posições %lu a %lu\n", (unsigned long)meta.sessao,
+                      (unsigned long)inicio(), (unsigned long)fim());
+    }
+
+    // Apaga os dois segmentos e começa uma sessão nova na posição 0
+    void clear() {
+        bloqueia();
+        if (LittleFS.exists(LOG_PATH)) LittleFS.remove(LOG_PATH);
+        if (LittleFS.exists(LOG_ANTERIOR_PATH)) LittleFS.remove(LOG_ANTERIOR_PATH);
+#ifdef ESP32
+        meta.sessao = esp_random();
+#else
+        meta.sessao = RANDOM_REG32;
+#endif
+        meta.base = meta.baseAnterior = 0;
+        tamAtual = 0;
+        salva();
+        libera();
+    }
+
+    File abre() { return LittleFS.open(LOG_PATH, "a"); }
+
+    // Fecha a gravação, publica o novo fim e rotaciona se o segmento encheu
+    void fecha(File &f) {
+        if (!f) return;
+        uint32_t tam = f.size();
+        f.close();
+        bloqueia();
+        tamAtual = tam;
+        if (tamAtual >= (leitores ? 2 * LOG_MAX_BYTES : LOG_MAX_BYTES)) rotaciona();
+        libera();
+    }
+
+    // Lê a partir da posição absoluta pos sem cruzar segmentos.
+    // Retorna 0 fora de [inicio(), fim()).
+    size_t le(uint32_t pos, uint8_t *buf, size_t len) {
+        bloqueia();
+        size_t lido = 0;
+        uint32_t fimAtual = meta.base + tamAtual;
+        if (pos >= meta.baseAnterior && pos < fimAtual) {
+            bool anterior = pos < meta.base;
+            uint32_t limite = anterior ? meta.base : fimAtual;
+            if (len > limite - pos) len = limite - pos;
+            File f = LittleFS.open(anterior ? LOG_ANTERIOR_PATH : LOG_PATH, "r");
+            if (f) {
+                f.seek(pos - (anterior ? meta.baseAnterior : meta.base));
+                lido = f.read(buf, len);
+                f.close();
+            }
+        }
+        libera();
+        return lido;
+    }
+
+    void fixa() { bloqueia(); leitores++; libera(); }
+    void solta() { bloqueia(); if (leitores) leitores--; libera(); }
+
+    uint32_t sessao() const { return meta.sessao; }
+    uint32_t inicio() const { return meta.baseAnterior; }   // byte mais antigo ainda guardado
+    uint32_t fim() const { return meta.base + tamAtual; }
+    uint32_t rotacoes = 0;
+
+private:
+    struct Meta {
+        uint32_t sessao;
+        uint32_t base;           // posição do byte 0 de /log.txt
+        uint32_t baseAnterior;   // posição do byte 0 de /log.1 (= base se não existir)
+    } meta = {0, 0, 0};
+    volatile uint32_t tamAtual = 0;
+    uint8_t leitores = 0;   // leituras longas em andamento (adiam a rotação)
+#ifdef ESP32
+    SemaphoreHandle_t trava = nullptr;   // gravação e servidor web rodam em tarefas diferentes
+#endif
+
+    void bloqueia() {
+#ifdef ESP32
+        if (trava) xSemaphoreTake(trava, portMAX_DELAY);
+#endif
+    }
+    void libera() {
+#ifdef ESP32
+        if (trava) xSemaphoreGive(trava);
+#endif
+    }
+
+    void rotaciona() {
+        if (LittleFS.exists(LOG_ANTERIOR_PATH)) LittleFS.remove(LOG_ANTERIOR_PATH);
+        LittleFS.rename(LOG_PATH, LOG_ANTERIOR_PATH);
+        meta.baseAnterior = meta.base;
+        meta.base += tamAtual;
+        tamAtual = 0;
+        rotacoes++;
+        salva();
+    }
+
+    void salva() {
+        File f = LittleFS.open(LOG_BASE_PATH, "w");
+        if (f) { f.write((const uint8_t*)&meta, sizeof(meta)); f.close(); }
+    }
+
+    static uint32_t tamanhoDe(const char *caminho) {
+        File f = LittleFS.open(caminho, "r");
+        if (!f) return 0;
+        uint32_t n = f.size();
+        f.close();
+        return n;
+    }
+};
+
+#endif // LOG_ROTATIVO_H
@@ -15,11 +15,9 @@
   #define ONEWIRE_PIN 32   // pino do DS18B20
 #endif
 
-// Estrutura de dados comum
-struct SensorData {
-  char nome_tx[16];
-  float temp;
-};
+#include "temperatura.h"
+#include "perfil_energia.h"
+#include "quadros.h"
 
 #if defined(ESP8266_TX)
   #include "esp8266_tx.h"
@@ -0,0 +1,374 @@
+#ifndef NUCLEO_RECEPTOR_H
+#define NUCLEO_RECEPTOR_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "temperatura.h"
+#include "quadros.h"
+#include "politica_envio.h"
+#include "registro_estacoes.h"
+
+// --------------------
+// Núcleo do receptor (ESP32, ESP8266 e host)
+// --------------------
+// O que o receptor faz com os quadros fica aqui, uma vez só:
+//  - pareamento e registro;
+//  - alertas por sonda e linhas do log;
+//  - detecção de faltantes;
+//  - conteúdo de /estacoes e /energia.
+// O que muda de placa para placa entra por quatro políticas, escolhidas em
+// tempo de compilação (métodos estáticos, sem virtual):
+//
+//   Radio          responde(mac, buf, len): envia a atribuição (pareamento
+//                  ou limites novos); pode ser chamado no callback do Wi-Fi
+//   Relogio        agora() -> DataHora do RTC; ms() -> milissegundos desde o
+//                  boot em 64 bits (millis() volta a zero em 49,7 dias)
+//   Armazenamento  grava(linha): entrega a linha ao log; le/cria/escreve e
+//                  Trava para o arquivo do registro (registro_estacoes.h) e
+//                  para o último quadro de cada estação, que as rotas web
+//                  copiam de outra tarefa
+//   Web            Texto e poe(texto, trecho): corpo das respostas HTTP
+//
+// O papel definido no main.cpp escolhe o arquivo: esp32_rx.h e esp8266_rx.h
+// montam o núcleo com as políticas da placa. politicas_host.h tem as do PC,
+// usadas por tools/bench_receptor.cpp.
+//
+// As linhas são montadas em buffer fixo com snprintf (sem String no caminho
+// do quadro), e a data é lida uma vez por quadro, não uma vez por sonda.
+
+#ifndef LINHA_MAX
+#define LINHA_MAX 160      // maior linha do log
+#endif
+#define AMBIENTE_MS 60000  // período da linha "Ambiente"
+#define SILENCIO_MS 1000   // período de verificaSilencio()
+#ifndef PAGINA_ESTACOES
+#define PAGINA_ESTACOES 64 // estações por resposta do /estacoes
+#endif
+
+struct DataHora {
+    uint16_t ano;
+    uint8_t mes, dia, hora, minuto, segundo;
+};
+
+// Cada sonda de um transmissor é um subcanal com série e alertas próprios;
+// nome e limites vêm do registro (registro_estacoes.h)
+struct ProbeState {
+    bool lowAlert;
+    bool highAlert;
+};
+
+// Estado de execução, indexado pelo ID curto da estação
+struct StationState {
+    ProbeState sondas[MAX_SONDAS];
+    bool conhecida;              // já recebeu algum quadro desde o boot
+    bool faltante;               // silêncio além da janela já registrado
+    uint64_t ultimoMs;           // instante do último quadro
+    uint64_t janelaMs;           // silêncio máximo pela política do TX (0 = desconhecida)
+};
+
+// Monta uma linha em buffer fixo; o que passar de LINHA_MAX é cortado
+struct Linha {
+    char texto[LINHA_MAX];
+    size_t len = 0;
+
+    Linha &poe(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (len >= sizeof(texto) - 1) return *this;
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(texto + len, sizeof(texto) - len, fmt, args);
+        va_end(args);
+        if (n > 0) len = len + n < sizeof(texto) ? len + n : sizeof(texto) - 1;
+        return *this;
+    }
+    Linha &poeData(const DataHora &d) {
+        return poe("%02u/%02u/%04u %02u:%02u:%02u", d.dia, d.mes, d.ano, d.hora, d.minuto, d.segundo);
+    }
+    Linha &poeCenti(int16_t cc) {
+        if (len + 8 > sizeof(texto)) return *this;
+        len += formatCenti(texto + len, sizeof(texto) - len, cc);
+        return *this;
+    }
+};
+
+template <class Radio, class Relogio, class Armazenamento, class Web>
+class NucleoReceptor {
+public:
+    using Texto = typename Web::Texto;
+
+    RegistroEstacoes<Armazenamento> registro;
+    SensorData dados[MAX_ESTACOES];        // último quadro de cada estação
+    StationState estados[MAX_ESTACOES];
+    volatile uint32_t desconhecidos = 0;   // dados de MAC fora do registro
+
+    // Carrega as estações pareadas em boots anteriores; retorna quantas.
+    // A janela de silêncio de cada uma começa agora, com a política guardada
+    // no registro: estação que não volta depois do reboot também fica
+    // faltante. Sem quadro algum desde o pareamento não há política, e a
+    // janela só abre no primeiro quadro.
+    uint16_t begin() {
+        trava.begin();
+        memset(estados, 0, sizeof(estados));
+        uint16_t n = registro.begin();
+        uint64_t agora = Relogio::ms();
+        for (uint16_t i = 0; i < n; i++) {
+            Estacao e = registro.copia(i);
+            if (!e.intervaloS) continue;
+            estados[i].ultimoMs = agora;
+            estados[i].janelaMs = janelaSilencioMs(e.intervaloS, e.heartbeat);
+        }
+        return n;
+    }
+
+    // Quadro do rádio (dados ou anúncio), já fora do callback do Wi-Fi
+    void processa(const uint8_t *mac, const uint8_t *buf, int len) {
+        if (anuncioValido(buf, len)) {
+            QuadroAnuncio a;
+            memcpy(&a, buf, sizeof(a));
+            processaAnuncio(mac, a);
+        } else if (quadroValido(buf, len)) {
+            SensorData d = {};
+            memcpy(&d, buf, (size_t)len < sizeof(d) ? (size_t)len : sizeof(d));
+            processaDados(mac, d);
+        }
+    }
+
+    void processaDados(const uint8_t *mac, const SensorData &d) {
+        int idx = registro.localiza(d.id, mac);
+        if (idx < 0) {
+            desconhecidos++;   // TX fora do registro: ele se reanuncia sozinho
+            return;
+        }
+        StationState &st = estados[idx];
+        trava.bloqueia();
+        dados[idx] = d;
+        st.conhecida = true;
+        st.faltante = false;
+        st.ultimoMs = Relogio::ms();
+        st.janelaMs = janelaSilencioMs(d);
+        trava.libera();
+
+        Estacao est = registro.copia(idx);
+        if (est.intervaloS != d.intervalo_s || est.heartbeat != d.heartbeat) {
+            registro.defineJanela(idx, d.intervalo_s, d.heartbeat);   // guarda para a janela do próximo boot
+        }
+        QuadroAtribuicao q = atribuicao(idx, est);
+        if (d.limites != assinaturaLimites(q.min_cc, q.max_cc)) {
+            Radio::responde(mac, (const uint8_t*)&q, sizeof(q));   // limite editado: o TX escuta logo após o ACK
+        }
+        DataHora agora = Relogio::agora();
+        uint8_t n = d.n_sondas < MAX_SONDAS ? d.n_sondas : MAX_SONDAS;
+        for (uint8_t s = 0; s < n; s++) linhaSonda(agora, est, st.sondas[s], s, d.temp_cc[s]);
+    }
+
+    // Registra (ou reconhece) o TX e responde com o ID curto
+    void processaAnuncio(const uint8_t *mac, const QuadroAnuncio &a) {
+        char nome[NOME_MAX + 1];
+        memcpy(nome, a.nome, NOME_MAX);
+        nome[NOME_MAX] = '\0';
+        bool novo;
+        int id = registro.registra(mac, nome, a.n_sondas, novo);
+        char macStr[18];
+        formataMac(macStr, mac);
+        if (id < 0) {
+            grava(Linha().poe("Registro cheio: anuncio de %s (%s) ignorado", nome, macStr));
+            return;
+        }
+        Estacao e = registro.copia(id);
+        QuadroAtribuicao q = atribuicao(id, e);
+        Radio::responde(mac, (const uint8_t*)&q, sizeof(q));
+        if (novo) grava(Linha().poe("Estacao pareada: %s (ID %d, %s)", e.nome, id, macStr));
+    }
+
+    void amostraAmbiente(int16_t cc) {
+        grava(Linha().poeData(Relogio::agora()).poe(" - Ambiente: ").poeCenti(cc).poe(" °C"));
+    }
+
+    // Silêncio dentro da janela = valor inalterado; além dela = estação
+    // faltante, com uma linha por subcanal (cada sonda é uma série no log).
+    // Vale também para a estação que ainda não mandou quadro desde o boot.
+    void verificaSilencio() {
+        uint64_t agora = Relogio::ms();
+        for (uint16_t i = 0; i < registro.total(); i++) {
+            StationState &st = estados[i];
+            if (!st.janelaMs || st.faltante) continue;
+            if (agora - st.ultimoMs > st.janelaMs) {
+                Estacao e = registro.copia(i);
+                for (uint8_t s = 0; s < nCanais(e); s++) {
+                    char nome[NOME_MAX + 4];
+                    nomeSonda(nome, sizeof(nome), e, s);
+                    grava(Linha().poe("Estacao faltante: %s", nome));
+                }
+                trava.bloqueia();
+                st.faltante = true;
+                trava.libera();
+            }
+        }
+    }
+
+    // --------------------
+    // Conteúdo das rotas web
+    // --------------------
+    // /estacoes?de=N: página do registro em JSON. min/max da estação são o
+    // padrão; "canais" traz nome e limites em vigor de cada sonda. "vigente" é o
+    // último valor da sonda, que segue valendo a cada intervalo_s sem quadro
+    // até a estação ficar faltante (null = sem valor)
+    void estacoesJson(Texto &out, uint16_t de) {
+        uint16_t total = registro.total();
+        uint16_t ate = (uint32_t)de + PAGINA_ESTACOES < total ? de + PAGINA_ESTACOES : total;
+        char buf[48];
+        snprintf(buf, sizeof(buf), "{\"total\":%u,\"max\":%u", total, (unsigned)MAX_ESTACOES);
+        Web::poe(out, buf);
+        snprintf(buf, sizeof(buf), ",\"desconhecidos\":%lu,\"estacoes\":[", (unsigned long)desconhecidos);
+        Web::poe(out, buf);
+        for (uint16_t i = de; i < ate; i++) {
+            Estacao e = registro.copia(i);
+            SensorData d;
+            StationState st;
+            copiaQuadro(i, d, st);
+            uint64_t agora = Relogio::ms();   // depois da cópia: nunca antes do último quadro
+            char mac[18], silencio[21];
+            formataMac(mac, e.mac);
+            if (st.conhecida) snprintf(silencio, sizeof(silencio), "%lu", (unsigned long)((agora - st.ultimoMs) / 1000));
+            else strcpy(silencio, "null");
+            Linha l;
+            l.poe("%s{\"id\":%u,\"nome\":\"%s\",\"mac\":\"%s\"", i > de ? "," : "", i, e.nome, mac);
+            l.poe(",\"sondas\":%u,\"min\":", e.nSondas).poeCenti(e.minCC).poe(",\"max\":").poeCenti(e.maxCC);
+            l.poe(",\"silencio_s\":%s,\"faltante\":%s", silencio, st.faltante ? "true" : "false");
+            Web::poe(out, l.texto);
+
+            bool vale = st.conhecida && !st.faltante;
+            Linha v;
+            v.poe(",\"intervalo_s\":");
+            if (vale) v.poe("%lu", (unsigned long)d.intervalo_s); else v.poe("null");
+            Web::poe(out, v.poe(",\"canais\":[").texto);
+            for (uint8_t s = 0; s < nCanais(e); s++) {
+                char nome[NOME_MAX + 4];
+                nomeSonda(nome, sizeof(nome), e, s);
+                Linha c;
+                c.poe("%s{\"sonda\":%u,\"nome\":\"%s\",\"min\":", s ? "," : "", s + 1, nome).poeCenti(minSonda(e, s));
+                c.poe(",\"max\":").poeCenti(maxSonda(e, s)).poe(",\"vigente\":");
+                if (vale && s < d.n_sondas && d.temp_cc[s] != TEMP_DESCONECTADO_CC) c.poeCenti(d.temp_cc[s]);
+                else c.poe("null");
+                Web::poe(out, c.poe("}").texto);
+            }
+            Web::poe(out, "]}");
+        }
+        Web::poe(out, "]}");
+    }
+
+    // POST /estacoes id=3&nome=Geladeira2&min=2.5&max=8 edita a estação (o
+    // padrão das sondas); com sonda=2, só aquela sonda, e lá nome, min ou max
+    // vazios voltam ao padrão. nullptr = ausente. Retorna o código HTTP; msg é
+    // o corpo da resposta. O log ganha uma linha "editada" por sonda afetada,
+    // com o nome e os limites que ela passa a usar.
+    int editaEstacao(const char *id, const char *sonda, const char *nome, const char *txtMin, const char *txtMax, const char *&msg) {
+        int s = sonda ? atoi(sonda) - 1 : -1;
+        int16_t minCC, maxCC;
+        if (!id || (sonda && (s < 0 || s >= MAX_SONDAS)) ||
+            (txtMin && !leLimite(txtMin, s >= 0, minCC)) || (txtMax && !leLimite(txtMax, s >= 0, maxCC))) {
+            msg = "Use id=<n>, sonda=<1..n> opcional e nome, min e/ou max (°C, ex.: 2.5)";
+            return 400;
+        }
+        uint16_t i = atoi(id);
+        if (i >= registro.total()) {
+            msg = "Estacao nao registrada";
+            return 404;
+        }
+        if (!registro.edita(i, s, nome, txtMin ? &minCC : nullptr, txtMax ? &maxCC : nullptr)) {
+            msg = "Nome vazio ou min > max";
+            return 400;
+        }
+        Estacao e = registro.copia(i);
+        for (uint8_t k = 0; k < nCanais(e); k++) {
+            if (s >= 0 && k != s) continue;
+            char nomeCanal[NOME_MAX + 4];
+            nomeSonda(nomeCanal, sizeof(nomeCanal), e, k);
+            grava(Linha().poe("Estacao %u sonda %u editada: %s [", i, k + 1, nomeCanal)
+                      .poeCenti(minSonda(e, k)).poe(", ").poeCenti(maxSonda(e, k)).poe("]"));
+        }
+        msg = "OK";
+        return 200;
+    }
+
+    // /energia: último perfil de cada estação (fases em unidades de 100 µs), para tools/energia.cpp
+    void energiaCsv(Texto &out) {
+        Web::poe(out, "estacao,seq,resolucao,intervalo_s,heartbeat,boot,conversao,radio,envio,ack\n");
+        for (uint16_t i = 0; i < registro.total(); i++) {
+            SensorData d;
+            StationState st;
+            copiaQuadro(i, d, st);
+            if (!st.conhecida) continue;
+            Linha l;
+            l.poe("%s,%u,%u,%lu,%u", registro.copia(i).nome, d.seq, d.resolucao, (unsigned long)d.intervalo_s, d.heartbeat);
+            for (uint8_t f = 0; f < N_FASES; f++) l.poe(",%u", d.fases[f]);
+            Web::poe(out, l.poe("\n").texto);
+        }
+    }
+
+private:
+    typename Armazenamento::Trava trava;   // dados[] e estados[]: a ingestão escreve, a web lê
+
+    static void grava(const Linha &l) { Armazenamento::grava(l.texto); }
+
+    // Último quadro e situação da estação, sem pegar um quadro pela metade
+    // (os alertas por sonda são só da ingestão e ficam de fora)
+    void copiaQuadro(uint16_t i, SensorData &d, StationState &st) {
+        trava.bloqueia();
+        d = dados[i];
+        st.conhecida = estados[i].conhecida;
+        st.faltante = estados[i].faltante;
+        st.ultimoMs = estados[i].ultimoMs;
+        st.janelaMs = estados[i].janelaMs;
+        trava.libera();
+    }
+
+    // ID curto e limites em vigor de cada sonda, para o TX decidir o envio
+    static QuadroAtribuicao atribuicao(uint16_t id, const Estacao &e) {
+        QuadroAtribuicao q = {};
+        q.tipo = QUADRO_ATRIBUICAO;
+        q.id = id;
+        for (uint8_t s = 0; s < MAX_SONDAS; s++) {
+            q.min_cc[s] = minSonda(e, s);
+            q.max_cc[s] = maxSonda(e, s);
+        }
+        return q;
+    }
+
+    // Limite em °C; numa sonda, texto vazio = herda o da estação
+    static bool leLimite(const char *txt, bool daSonda, int16_t &cc) {
+        if (daSonda && txt[0] == '\0') {
+            cc = HERDA_ESTACAO;
+            return true;
+        }
+        return textoParaCenti(txt, cc);
+    }
+
+    void linhaSonda(const DataHora &agora, const Estacao &est, ProbeState &ch, uint8_t sonda, int16_t temp) {
+        char nome[NOME_MAX + 4];
+        nomeSonda(nome, sizeof(nome), est, sonda);
+        int16_t minCC = minSonda(est, sonda), maxCC = maxSonda(est, sonda);
+        Linha l;
+        l.poeData(agora).poe(" - Est: %s | Temp: ", nome).poeCenti(temp).poe(" °C");
+
+        if (temp < minCC && !ch.lowAlert) {
+            l.poe(" <<< ALERTA: abaixo de ").poeCenti(minCC).poe(" °C!");
+            ch.lowAlert = true;
+            ch.highAlert = false;
+        } else if (temp > maxCC && !ch.highAlert) {
+            l.poe(" <<< ALERTA: acima de ").poeCenti(maxCC).poe(" °C");
+            ch.highAlert = true;
+            ch.lowAlert = false;
+        } else if (temp >= minCC && temp <= maxCC) {
+            if (ch.lowAlert || ch.highAlert) l.poe(" <<< NORMALIZADO");
+            ch.lowAlert = false;
+            ch.highAlert = false;
+        }
+        grava(l);
+    }
+};
+
+#endif // NUCLEO_RECEPTOR_H
@@ -0,0 +1,55 @@
+#ifndef PERFIL_ENERGIA_H
+#define PERFIL_ENERGIA_H
+
+// --------------------
+// Perfil de energia do despertar (transmissores)
+// --------------------
+// Cada fase do despertar é cronometrada em unidades de 100 µs. Ao fim de um
+// despertar que transmitiu, o registro completo (todas as fases do mesmo
+// despertar) vai para a memória RTC, e o quadro seguinte o leva ao receptor
+// (/energia); o tools/energia.cpp transforma isso em mAh por ciclo e
+// autonomia da bateria. Os despertares silenciosos não ligam o rádio e não
+// fecham registro.
+
+#include <stdint.h>
+
+enum FaseEnergia : uint8_t {
+    FASE_BOOT = 0,      // reset até o início do setup()
+    FASE_CONVERSAO,     // busca/conversão/leitura das sondas
+    FASE_RADIO,         // Wi-Fi + ESP-NOW + peer
+    FASE_ENVIO,         // chamada de esp_now_send
+    FASE_ACK,           // espera do ACK da camada MAC e da janela de limites (LIMITES_MS)
+    N_FASES
+};
+
+#ifndef ACK_TIMEOUT_US
+#define ACK_TIMEOUT_US 50000UL
+#endif
+
+// Converte µs em unidades de 100 µs, saturando em 6,5 s
+inline uint16_t paraDecimoMs(uint32_t us) {
+    uint32_t v = us / 100;
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+#ifdef ARDUINO   // o enum acima também é usado no host (quadros.h)
+class Cronometro {
+public:
+    explicit Cronometro(uint16_t *fases) : fases(fases), inicio(micros()) {
+        fases[FASE_BOOT] = paraDecimoMs(inicio);   // micros() conta desde o reset
+    }
+
+    // Fecha a fase atual e começa a próxima
+    void marca(FaseEnergia fase) {
+        uint32_t agora = micros();
+        fases[fase] = paraDecimoMs(agora - inicio);
+        inicio = agora;
+    }
+
+private:
+    uint16_t *fases;
+    uint32_t inicio;
+};
+#endif
+
+#endif // PERFIL_ENERGIA_H
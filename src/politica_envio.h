@@ -0,0 +1,238 @@
+#ifndef POLITICA_ENVIO_H
+#define POLITICA_ENVIO_H
+
+// --------------------
+// Política de envio por mudança (transmissores)
+// --------------------
+// O transmissor acorda a cada SEND_INTERVAL, lê as sondas e só liga o rádio se,
+// em qualquer sonda:
+//  - a leitura se afastou mais que BANDA_MORTA °C do último valor enviado;
+//  - a leitura cruzou o limite mínimo ou máximo da sonda em relação ao último
+//    valor enviado;
+// ou se HEARTBEAT despertares se passaram sem envio. Os limites são os do
+// registro do receptor (padrão da estação ou os da sonda), que chegam na
+// atribuição; até o primeiro pareamento valem TEMP_MIN/TEMP_MAX.
+// O receptor recebe seq/heartbeat/intervalo_s em cada quadro e, com isso,
+// sabe que um silêncio menor que HEARTBEAT ciclos significa "sem alteração".
+// O log só guarda as mudanças: o receptor expõe o valor vigente de cada sonda
+// em /estacoes, e a série completa (o valor repetido a cada intervalo) é
+// remontada no host por tools/analise_log.cpp.
+
+#include "temperatura.h"
+#include "quadros.h"
+
+#ifndef BANDA_MORTA
+#define BANDA_MORTA 0.25
+#endif
+#ifndef BANDA_MORTA_CC   // tools/energia.cpp troca banda e heartbeat por variáveis
+#define BANDA_MORTA_CC centiDeGraus(BANDA_MORTA)
+#endif
+#ifndef HEARTBEAT
+#define HEARTBEAT 10
+#endif
+
+#ifndef TIMEOUT_MS
+#define TIMEOUT_MS 7000       // tolerância de recepção somada à janela de silêncio
+#endif
+
+#define RTC_MAGIC 0x45534E57UL   // "ESNW": distingue RTC válido de lixo após power-on
+
+// Pareamento com o receptor (registro_estacoes.h no RX)
+#ifndef REANUNCIO
+#define REANUNCIO 100         // envios entre anúncios de confirmação (recupera registro apagado)
+#endif
+#define FALHAS_REPAREAR 3     // envios seguidos sem ACK: receptor trocado, pareia de novo
+#define PAREAMENTO_MS 150     // espera pela atribuição a cada anúncio
+#define PAREAMENTO_TENTATIVAS 3
+#define LIMITES_MS 20         // espera, depois do ACK, pela atribuição com limites novos
+
+enum MotivoEnvio : uint8_t {
+    ENVIO_PRIMEIRO  = 0,   // primeiro envio após ligar
+    ENVIO_VARIACAO  = 1,   // saiu da banda morta
+    ENVIO_LIMITE    = 2,   // cruzou o limite mínimo ou máximo da sonda
+    ENVIO_HEARTBEAT = 3    // tempo máximo sem envio
+};
+
+// Estado mantido na memória RTC entre deep sleeps
+struct alignas(4) TxRtcState {   // alinhado: a RTC do ESP8266 é lida em palavras de 32 bits
+    uint32_t magic;
+    uint16_t seq;                      // contador de despertares
+    uint16_t ciclosSemEnvio;           // despertares desde o último envio
+    uint8_t nSondas;                   // posições ocupadas em rom (0 = nenhuma sonda vista)
+    bool refazerBusca;                 // sonda não respondeu: busca OneWire no próximo despertar
+    uint8_t ausentes;                  // bit por posição: sonda que faltou na última busca
+    uint8_t rom[MAX_SONDAS][8];        // ROM IDs das sondas; a posição é a sonda no quadro
+    int16_t ultimaTemp[MAX_SONDAS];    // últimos valores enviados (centésimos de °C)
+    int16_t minCC[MAX_SONDAS];         // limites de cada sonda, da última atribuição
+    int16_t maxCC[MAX_SONDAS];
+    uint16_t fases[N_FASES];           // fases do último despertar que transmitiu (perfil_energia.h)
+    uint16_t idCurto;                  // ID atribuído pelo receptor (ID_NENHUM = parear)
+    uint8_t macRx[6];                  // receptor que respondeu ao pareamento
+    uint8_t falhasSeguidas;            // envios sem ACK desde o último com ACK
+    uint16_t enviosDesdeAnuncio;
+};
+static_assert(MAX_SONDAS <= 8, "TxRtcState::ausentes tem um bit por sonda");
+
+// Faixa da leitura em relação aos limites: -1 abaixo, 0 normal, 1 acima
+inline int8_t faixaTemp(int16_t temp, int16_t minCC, int16_t maxCC) {
+    if (temp < minCC) return -1;
+    if (temp > maxCC) return 1;
+    return 0;
+}
+
+// Descarta as referências enviadas (próximo despertar envia tudo)
+inline void invalidaReferencias(TxRtcState &st) {
+    for (uint8_t i = 0; i < MAX_SONDAS; i++) st.ultimaTemp[i] = TEMP_INVALIDA_CC;
+}
+
+// Início do despertar: valida o estado RTC e avança o contador
+inline uint16_t iniciaDespertar(TxRtcState &st) {
+    if (st.magic != RTC_MAGIC) {
+        st.magic = RTC_MAGIC;
+        st.seq = 0;
+        st.ciclosSemEnvio = 0;
+        st.nSondas = 0;
+        st.refazerBusca = true;
+        st.ausentes = 0;
+        memset(st.fases, 0, sizeof(st.fases));
+        st.idCurto = ID_NENHUM;
+        for (uint8_t i = 0; i < MAX_SONDAS; i++) {
+            st.minCC[i] = TEMP_MIN_CC;
+            st.maxCC[i] = TEMP_MAX_CC;
+        }
+        st.falhasSeguidas = 0;
+        st.enviosDesdeAnuncio = 0;
+        invalidaReferencias(st);   // nada enviado ainda
+    }
+    return ++st.seq;
+}
+
+// Busca OneWire quando uma sonda sumiu e no despertar do heartbeat, que acha
+// sondas ligadas depois; nos demais despertares vale o cache de ROM IDs
+inline bool precisaBuscarSondas(const TxRtcState &st) {
+    return st.refazerBusca || st.ciclosSemEnvio + 1 >= HEARTBEAT;
+}
+
+// Junta o resultado da busca ao cache sem mudar ninguém de posição: no
+// receptor, nome, limites e série são por posição (ConfigSonda). Sonda já
+// conhecida fica onde estava; sonda nova entra no fim; sonda que não apareceu
+// mantém a posição, marcada ausente, e segue saindo como -127.00. Com todas
+// as posições ocupadas, uma sonda nova toma a de uma ausente (sonda trocada).
+// Só a posição que ganhou sonda nova descarta a referência. Retorna true se
+// alguma posição mudou. Depois de perder a energia a RTC zera, e a ordem
+// volta a ser a da busca (a mesma para o mesmo conjunto de sondas).
+inline bool atualizaSondas(TxRtcState &st, const uint8_t rom[][8], uint8_t n) {
+    st.refazerBusca = false;
+    uint8_t vistas = 0;
+    bool nova[MAX_SONDAS];
+    for (uint8_t i = 0; i < n; i++) {
+        nova[i] = true;
+        for (uint8_t p = 0; p < st.nSondas && nova[i]; p++) {
+            if (memcmp(rom[i], st.rom[p], 8) == 0) { vistas |= 1 << p; nova[i] = false; }
+        }
+    }
+    bool mudou = false;
+    for (uint8_t i = 0; i < n; i++) {
+        if (!nova[i]) continue;
+        uint8_t p = st.nSondas;
+        if (p < MAX_SONDAS) st.nSondas++;
+        else for (p = 0; p < MAX_SONDAS && (vistas & (1 << p)); p++) {}
+        if (p >= MAX_SONDAS) break;   // sem posição livre nem ausente
+        memcpy(st.rom[p], rom[i], 8);
+        st.ultimaTemp[p] = TEMP_INVALIDA_CC;
+        vistas |= 1 << p;
+        mudou = true;
+    }
+    uint8_t ausentes = (uint8_t)(((1u << st.nSondas) - 1) & ~vistas);
+    mudou |= ausentes != st.ausentes;
+    st.ausentes = ausentes;
+    return mudou;
+}
+
+// Leitura -127.00 numa posição que a última busca achou: a sonda sumiu
+// agora e vale buscar de novo. Posição já ausente só volta no heartbeat.
+inline bool sondaSumiu(const TxRtcState &st, const int16_t *temps, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+        if (temps[i] == TEMP_DESCONECTADO_CC && !(st.ausentes & (1 << i))) return true;
+    }
+    return false;
+}
+
+// Decide se o despertar atual deve transmitir; preenche o motivo
+inline bool deveEnviar(const TxRtcState &st, const int16_t *temps, uint8_t n, uint8_t &motivo) {
+    for (uint8_t i = 0; i < n; i++) {
+        if (st.ultimaTemp[i] == TEMP_INVALIDA_CC) { motivo = ENVIO_PRIMEIRO; return true; }
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        if (faixaTemp(temps[i], st.minCC[i], st.maxCC[i]) != faixaTemp(st.ultimaTemp[i], st.minCC[i], st.maxCC[i])) {
+            motivo = ENVIO_LIMITE;
+            return true;
+        }
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t delta = (int32_t)temps[i] - st.ultimaTemp[i];
+        if (delta >= BANDA_MORTA_CC || -delta >= BANDA_MORTA_CC) { motivo = ENVIO_VARIACAO; return true; }
+    }
+    if (st.ciclosSemEnvio + 1 >= HEARTBEAT) { motivo = ENVIO_HEARTBEAT; return true; }
+    return false;
+}
+
+// Fim do despertar: só um envio bem-sucedido atualiza as referências
+inline void finalizaDespertar(TxRtcState &st, const int16_t *temps, uint8_t n, bool enviado) {
+    if (enviado) {
+        for (uint8_t i = 0; i < n; i++) st.ultimaTemp[i] = temps[i];
+        st.ciclosSemEnvio = 0;
+    } else if (st.ciclosSemEnvio < 0xFFFF) {
+        st.ciclosSemEnvio++;
+    }
+}
+
+// Anuncia quando não tem ID, periodicamente para confirmar o registro do
+// receptor, e depois de várias falhas seguidas (receptor trocado)
+inline bool precisaAnunciar(const TxRtcState &st) {
+    return st.idCurto == ID_NENHUM || st.enviosDesdeAnuncio >= REANUNCIO || st.falhasSeguidas >= FALHAS_REPAREAR;
+}
+
+// Atribuição recebida (anúncio ou resposta a um quadro com limites antigos):
+// guarda o ID e os limites. O quadro que provocou a resposta já foi avaliado
+// pelo receptor com o limite novo, então as referências continuam valendo.
+inline void aplicaAtribuicao(TxRtcState &st, const QuadroAtribuicao &q) {
+    st.idCurto = q.id;
+    memcpy(st.minCC, q.min_cc, sizeof(st.minCC));
+    memcpy(st.maxCC, q.max_cc, sizeof(st.maxCC));
+}
+
+// Assinatura que vai no quadro de dados (quadros.h)
+inline uint16_t assinaturaLimites(const TxRtcState &st) {
+    return assinaturaLimites(st.minCC, st.maxCC);
+}
+
+// Resultado do pareamento: só uma atribuição recebida zera os contadores
+inline void registraAnuncio(TxRtcState &st, bool atribuido) {
+    if (!atribuido) return;
+    st.enviosDesdeAnuncio = 0;
+    st.falhasSeguidas = 0;
+}
+
+// Resultado de um envio de dados (ACK da camada MAC)
+inline void registraEnvio(TxRtcState &st, bool ack) {
+    if (ack) {
+        st.falhasSeguidas = 0;
+        if (st.enviosDesdeAnuncio < 0xFFFF) st.enviosDesdeAnuncio++;
+    } else if (st.falhasSeguidas < 0xFF) {
+        st.falhasSeguidas++;
+    }
+}
+
+// Lado do receptor: tempo máximo de silêncio esperado para a estação antes
+// de considerá-la faltante (heartbeat completo + tolerância de recepção).
+// Em 64 bits: HEARTBEAT=10 com intervalo de 5 dias já passa de 2^32 ms.
+inline uint64_t janelaSilencioMs(uint32_t intervaloS, uint16_t heartbeat) {
+    uint64_t ciclos = heartbeat ? heartbeat : 1;
+    return ciclos * intervaloS * 1000ULL + TIMEOUT_MS;
+}
+inline uint64_t janelaSilencioMs(const SensorData &data) {
+    return janelaSilencioMs(data.intervalo_s, data.heartbeat);
+}
+
+#endif // POLITICA_ENVIO_H
@@ -0,0 +1,76 @@
+#ifndef POLITICAS_ARDUINO_H
+#define POLITICAS_ARDUINO_H
+
+// --------------------
+// Políticas do núcleo do receptor comuns às duas placas (nucleo_receptor.h)
+// --------------------
+// Relógio no DS1307, registro de estações no LittleFS e respostas web em
+// String. Rádio e gravação do log mudam de placa para placa e ficam em
+// esp32_rx.h / esp8266_rx.h.
+
+#include <LittleFS.h>
+#include <RTClib.h>
+
+#include "nucleo_receptor.h"
+
+RTC_DS1307 rtc;
+
+struct RelogioRtc {
+    static DataHora agora() {
+        DateTime t = rtc.now();
+        return { t.year(), t.month(), t.day(), t.hour(), t.minute(), t.second() };
+    }
+#ifdef ESP32
+    static uint64_t ms() { return esp_timer_get_time() / 1000; }
+#else
+    static uint64_t ms() { return micros64() / 1000; }
+#endif
+};
+
+struct ArquivosLittleFS {
+    static size_t le(const char *caminho, uint32_t pos, void *buf, size_t len) {
+        File f = LittleFS.open(caminho, "r");
+        if (!f) return 0;
+        size_t n = f.seek(pos) ? f.read((uint8_t*)buf, len) : 0;
+        f.close();
+        return n;
+    }
+
+    static bool cria(const char *caminho, const void *buf, size_t len) {
+        File f = LittleFS.open(caminho, "w");
+        if (!f) return false;
+        bool ok = f.write((const uint8_t*)buf, len) == len;
+        f.close();
+        return ok;
+    }
+
+    // Regrava um trecho sem truncar o resto do arquivo
+    static bool escreve(const char *caminho, uint32_t pos, const void *buf, size_t len) {
+        File f = LittleFS.open(caminho, "r+");
+        if (!f) return false;
+        bool ok = f.seek(pos) && f.write((const uint8_t*)buf, len) == len;
+        f.close();
+        return ok;
+    }
+
+    // No ESP32 a ingestão e o servidor web rodam em tarefas diferentes
+    struct Trava {
+#ifdef ESP32
+        SemaphoreHandle_t m = nullptr;
+        void begin() { m = xSemaphoreCreateMutex(); }
+        void bloqueia() { if (m) xSemaphoreTake(m, portMAX_DELAY); }
+        void libera() { if (m) xSemaphoreGive(m); }
+#else
+        void begin() {}
+        void bloqueia() {}
+        void libera() {}
+#endif
+    };
+};
+
+struct WebString {
+    using Texto = String;
+    static void poe(String &t, const char *s) { t += s; }
+};
+
+#endif // POLITICAS_ARDUINO_H
@@ -0,0 +1,105 @@
+#ifndef POLITICAS_HOST_H
+#define POLITICAS_HOST_H
+
+// --------------------
+// Políticas do núcleo do receptor para o PC (nucleo_receptor.h)
+// --------------------
+// O relógio é simulado: avanca(ms) faz o tempo andar, para reproduzir dias de
+// heartbeat em milissegundos. O registro é gravado em arquivos comuns dentro
+// de ArmazenamentoHost::dir. As linhas do log ficam em memória, ou vão para
+// um FILE* se saida estiver definido. As atribuições enviadas pelo "rádio"
+// ficam guardadas para conferência.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nucleo_receptor.h"
+
+struct RelogioHost {
+    static inline uint64_t msSimulado = 0;
+    static inline time_t inicio = 1704067200;   // 01/01/2024 00:00:00
+
+    static void avanca(uint64_t ms) { msSimulado += ms; }
+    static uint64_t ms() { return msSimulado; }
+    static DataHora agora() {
+        time_t t = inicio + (time_t)(msSimulado / 1000);
+        struct tm c;
+        gmtime_r(&t, &c);
+        return { (uint16_t)(c.tm_year + 1900), (uint8_t)(c.tm_mon + 1), (uint8_t)c.tm_mday,
+                 (uint8_t)c.tm_hour, (uint8_t)c.tm_min, (uint8_t)c.tm_sec };
+    }
+};
+
+struct RadioHost {
+    struct Envio {
+        uint8_t mac[6];
+        QuadroAtribuicao quadro;
+    };
+    static inline std::vector<Envio> enviados;
+
+    static bool responde(const uint8_t *mac, const uint8_t *buf, size_t len) {
+        Envio e = {};
+        memcpy(e.mac, mac, 6);
+        memcpy(&e.quadro, buf, len < sizeof(e.quadro) ? len : sizeof(e.quadro));
+        enviados.push_back(e);
+        return true;
+    }
+};
+
+struct ArmazenamentoHost {
+    static inline std::string dir = ".";
+    static inline FILE *saida = nullptr;            // nullptr = guarda em linhas
+    static inline std::vector<std::string> linhas;
+    static inline uint64_t gravadas = 0, bytes = 0;
+
+    static void grava(const char *linha) {
+        size_t n = strlen(linha);
+        gravadas++;
+        bytes += n + 2;
+        if (saida) fprintf(saida, "%s\r\n", linha);
+        else linhas.emplace_back(linha, n);
+    }
+
+    static size_t le(const char *caminho, uint32_t pos, void *buf, size_t len) {
+        FILE *f = fopen((dir + caminho).c_str(), "rb");
+        if (!f) return 0;
+        size_t n = fseek(f, pos, SEEK_SET) == 0 ? fread(buf, 1, len, f) : 0;
+        fclose(f);
+        return n;
+    }
+    static bool cria(const char *caminho, const void *buf, size_t len) {
+        FILE *f = fopen((dir + caminho).c_str(), "wb");
+        if (!f) return false;
+        bool ok = fwrite(buf, 1, len, f) == len;
+        fclose(f);
+        return ok;
+    }
+    static bool escreve(const char *caminho, uint32_t pos, const void *buf, size_t len) {
+        FILE *f = fopen((dir + caminho).c_str(), "r+b");
+        if (!f) return false;
+        bool ok = fseek(f, pos, SEEK_SET) == 0 && fwrite(buf, 1, len, f) == len;
+        fclose(f);
+        return ok;
+    }
+
+    struct Trava {
+        std::mutex m;
+        void begin() {}
+        void bloqueia() { m.lock(); }
+        void libera() { m.unlock(); }
+    };
+};
+
+struct WebHost {
+    using Texto = std::string;
+    static void poe(std::string &t, const char *s) { t += s; }
+};
+
+using NucleoHost = NucleoReceptor<RadioHost, RelogioHost, ArmazenamentoHost, WebHost>;
+
+#endif // POLITICAS_HOST_H
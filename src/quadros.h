@@ -0,0 +1,88 @@
+#ifndef QUADROS_H
+#define QUADROS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "perfil_energia.h"
+
+// --------------------
+// Quadros ESP-NOW (transmissor <-> receptor)
+// --------------------
+// Sem dependência do Arduino: o núcleo do receptor também roda no host.
+
+#ifndef MAX_SONDAS
+#define MAX_SONDAS 4   // máximo de DS18B20 por transmissor
+#endif
+
+// Primeiro byte de todo quadro ESP-NOW
+enum TipoQuadro : uint8_t {
+    QUADRO_DADOS      = 0xD1,   // SensorData
+    QUADRO_ANUNCIO    = 0xA1,   // TX sem ID pedindo pareamento (broadcast)
+    QUADRO_ATRIBUICAO = 0xA2    // resposta do RX com o ID curto
+};
+
+#define ID_NENHUM 0xFFFF   // TX ainda não pareado
+
+// Estrutura de dados comum
+struct SensorData {
+    uint8_t tipo;         // QUADRO_DADOS
+    uint8_t motivo;       // MotivoEnvio do quadro
+    uint16_t id;          // ID curto atribuído pelo receptor no pareamento
+    uint16_t seq;         // contador de despertares do transmissor
+    uint16_t heartbeat;   // máximo de despertares sem envio (política do TX)
+    uint32_t intervalo_s; // período de deep sleep do TX em segundos
+    uint16_t fases[N_FASES]; // perfil de energia do TX (100 µs por unidade, perfil_energia.h)
+    uint16_t limites;     // assinaturaLimites() dos limites que o TX usa
+    uint8_t n_sondas;     // sondas válidas em temp_cc
+    uint8_t resolucao;    // resolução das sondas em bits
+    int16_t temp_cc[MAX_SONDAS]; // temperaturas em centésimos de °C, uma por sonda
+};
+
+// Pareamento: o TX anuncia o nome em broadcast e o RX responde com o ID curto
+// e os limites em vigor de cada sonda. Depois disso os quadros de dados levam
+// só o ID (o nome fica no registro do RX) e a assinatura dos limites; se ela
+// não bate com o registro (limite editado pela web), o RX responde ao quadro
+// com uma nova atribuição.
+struct QuadroAnuncio {
+    uint8_t tipo;         // QUADRO_ANUNCIO
+    uint8_t n_sondas;
+    char nome[16];        // TX_ID: nome inicial da estação no registro
+};
+
+struct QuadroAtribuicao {
+    uint8_t tipo;         // QUADRO_ATRIBUICAO
+    uint8_t reservado;
+    uint16_t id;
+    int16_t min_cc[MAX_SONDAS];   // limites em vigor por sonda, centésimos de °C
+    int16_t max_cc[MAX_SONDAS];
+};
+
+// FNV-1a dos limites, dobrado em 16 bits: o TX manda, o RX confere
+inline uint16_t assinaturaLimites(const int16_t *minCC, const int16_t *maxCC) {
+    uint32_t h = 2166136261UL;
+    for (uint8_t i = 0; i < 2 * MAX_SONDAS; i++) {
+        uint16_t v = (uint16_t)(i < MAX_SONDAS ? minCC[i] : maxCC[i - MAX_SONDAS]);
+        h ^= v & 0xFF; h *= 16777619UL;
+        h ^= v >> 8;   h *= 16777619UL;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+// O quadro só leva as sondas presentes
+inline size_t tamanhoQuadro(uint8_t n_sondas) {
+    return offsetof(SensorData, temp_cc) + n_sondas * sizeof(int16_t);
+}
+
+// Valida um quadro recebido de tamanho variável
+inline bool quadroValido(const uint8_t *buf, int len) {
+    if (len < (int)offsetof(SensorData, temp_cc) || buf[0] != QUADRO_DADOS) return false;
+    uint8_t n = ((const SensorData *)buf)->n_sondas;
+    return n <= MAX_SONDAS && len >= (int)tamanhoQuadro(n);
+}
+
+inline bool anuncioValido(const uint8_t *buf, int len) {
+    return len >= (int)sizeof(QuadroAnuncio) && buf[0] == QUADRO_ANUNCIO;
+}
+
+#endif // QUADROS_H
@@ -0,0 +1,301 @@
+#ifndef REGISTRO_ESTACOES_H
+#define REGISTRO_ESTACOES_H
+
+// --------------------
+// Registro de estações (receptores)
+// --------------------
+// As estações não são mais fixas no build: cada transmissor novo se anuncia
+// (QuadroAnuncio) e recebe um ID curto, que é o índice dele nesta tabela.
+// O registro fica em /estacoes.bin (cabeçalho e um registro de tamanho fixo
+// por estação, na ordem dos IDs) e é carregado inteiro no boot. O cabeçalho
+// guarda MAX_SONDAS e o tamanho do registro: um arquivo gravado por outro
+// build é descartado em vez de lido com o deslocamento errado. O acesso ao arquivo e a
+// trava vêm da política de armazenamento do receptor (nucleo_receptor.h):
+//   le(caminho, pos, buf, len) -> bytes lidos     cria(caminho, buf, len)
+//   escreve(caminho, pos, buf, len)               Trava: begin/bloqueia/libera
+//
+// Buscas O(1): por ID é acesso direto; por MAC é um índice de endereçamento
+// aberto com o dobro do tamanho da tabela. IDs nunca são reaproveitados, então
+// o índice não precisa de remoção. Nome e limites podem ser editados pela web
+// sem reiniciar, da estação ou de uma sonda. Os limites da estação são o padrão das sondas: cada sonda
+// pode ter os seus e um nome próprio, senão herda. O intervalo e o heartbeat
+// do último quadro também ficam no registro: no boot o receptor já abre a
+// janela de silêncio de cada estação, sem esperar o primeiro quadro.
+//
+// Cadastro, edição e política nova só marcam a estação como pendente: quem
+// grava é persiste(), chamado pela tarefa que grava o log (ESP32) ou pelo
+// loop() (ESP8266), e regrava só os registros pendentes. Assim o flash nunca
+// é escrito pela ingestão, pelo servidor web nem pelo callback do Wi-Fi.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "temperatura.h"
+#include "quadros.h"
+
+#ifndef MAX_ESTACOES
+#ifdef ESP32
+#define MAX_ESTACOES 512
+#else
+#define MAX_ESTACOES 128   // RAM do ESP8266
+#endif
+#endif
+
+#define REGISTRO_PATH "/estacoes.bin"
+#define REGISTRO_MAGIC 0x31545345UL   // "EST1"
+#define NOME_MAX 16
+#define NOME_SONDA_MAX 12
+#define HERDA_ESTACAO TEMP_INVALIDA_CC   // limite da sonda = o da estação
+
+// Configuração de uma sonda (16 bytes)
+struct ConfigSonda {
+    char nome[NOME_SONDA_MAX];   // vazio = nome padrão do subcanal
+    int16_t minCC;               // HERDA_ESTACAO = limite da estação
+    int16_t maxCC;
+};
+
+// Registro persistido de uma estação (36 bytes + 16 por sonda)
+struct Estacao {
+    uint8_t mac[6];
+    uint8_t nSondas;        // informado no último anúncio
+    uint8_t reservado;
+    char nome[NOME_MAX];
+    int16_t minCC;          // limites padrão das sondas, em centésimos de °C
+    int16_t maxCC;
+    uint16_t heartbeat;     // política do TX no último quadro (janelaSilencioMs)
+    uint16_t reservado2;
+    uint32_t intervaloS;    // 0 = nenhum quadro recebido ainda
+    ConfigSonda sondas[MAX_SONDAS];
+};
+
+// Início de /estacoes.bin
+struct CabecalhoRegistro {
+    uint32_t magic;
+    uint16_t maxSondas;     // MAX_SONDAS do build que gravou
+    uint16_t tamEstacao;    // sizeof(Estacao) do build que gravou
+};
+
+inline int16_t minSonda(const Estacao &e, uint8_t sonda) {
+    return e.sondas[sonda].minCC == HERDA_ESTACAO ? e.minCC : e.sondas[sonda].minCC;
+}
+inline int16_t maxSonda(const Estacao &e, uint8_t sonda) {
+    return e.sondas[sonda].maxCC == HERDA_ESTACAO ? e.maxCC : e.sondas[sonda].maxCC;
+}
+
+// Subcanais da estação: um por sonda; sem sonda, o TX ainda manda um (-127.00)
+inline uint8_t nCanais(const Estacao &e) {
+    return e.nSondas < 1 ? 1 : (e.nSondas > MAX_SONDAS ? MAX_SONDAS : e.nSondas);
+}
+
+// Nome do subcanal: o da sonda, se editado; senão "Garrafa1" (sonda 1), "Garrafa1/2"...
+inline void nomeSonda(char *buf, size_t tam, const Estacao &e, uint8_t sonda) {
+    if (e.sondas[sonda].nome[0]) snprintf(buf, tam, "%s", e.sondas[sonda].nome);
+    else if (sonda == 0) snprintf(buf, tam, "%s", e.nome);
+    else snprintf(buf, tam, "%s/%u", e.nome, sonda + 1);
+}
+
+// "AA:BB:CC:DD:EE:FF" (buf com 18 bytes)
+inline void formataMac(char *buf, const uint8_t *mac) {
+    snprintf(buf, 18, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+// Menor potência de 2 >= n
+constexpr uint32_t potenciaDe2(uint32_t n, uint32_t p = 1) { return p >= n ? p : potenciaDe2(n, p * 2); }
+
+template <class Armazenamento>
+class RegistroEstacoes {
+public:
+    static const uint16_t TAM_INDICE = potenciaDe2(2 * MAX_ESTACOES);
+
+    // Carrega o arquivo (ou cria um vazio); retorna quantas estações havia
+    uint16_t begin() {
+        trava.begin();
+        n = 0;
+        memset(indice, 0xFF, sizeof(indice));
+        const CabecalhoRegistro esperado = { REGISTRO_MAGIC, MAX_SONDAS, sizeof(Estacao) };
+        CabecalhoRegistro cab = {};
+        if (Armazenamento::le(REGISTRO_PATH, 0, &cab, sizeof(cab)) != sizeof(cab) ||
+            memcmp(&cab, &esperado, sizeof(cab)) != 0) {
+            Armazenamento::cria(REGISTRO_PATH, &esperado, sizeof(esperado));   // TXs pareiam de novo
+            return 0;
+        }
+        size_t lidos = Armazenamento::le(REGISTRO_PATH, sizeof(cab), tabela, sizeof(tabela));
+        for (uint16_t i = 0; i < lidos / sizeof(Estacao); i++) indexa(i);
+        n = lidos / sizeof(Estacao);
+        return n;
+    }
+
+    // ID da estação com este MAC, cadastrando se for nova; -1 se a tabela encheu.
+    // novo indica se o cadastro aconteceu agora.
+    int registra(const uint8_t *mac, const char *nome, uint8_t nSondas, bool &novo) {
+        trava.bloqueia();
+        int id = buscaMac(mac);
+        novo = id < 0;
+        if (novo) {
+            if (n >= MAX_ESTACOES) { trava.libera(); return -1; }
+            id = n;
+            Estacao &e = tabela[id];
+            memset(&e, 0, sizeof(e));
+            memcpy(e.mac, mac, 6);
+            copiaNome(e.nome, nome, NOME_MAX);
+            if (nomeRepetido(e.nome, id)) {
+                // Dois TX com o mesmo TX_ID: o novo leva o ID no nome até ser renomeado
+                char sufixo[8];
+                size_t len = snprintf(sufixo, sizeof(sufixo), "#%d", id);
+                size_t corte = NOME_MAX - 1 - len;
+                if (strlen(e.nome) > corte) e.nome[corte] = '\0';
+                strcat(e.nome, sufixo);
+            }
+            e.nSondas = nSondas;
+            e.minCC = TEMP_MIN_CC;
+            e.maxCC = TEMP_MAX_CC;
+            herdaTudo(e);
+            indexa(id);
+            n++;   // só depois de preencher: localiza() lê n sem a trava
+            salva(id);
+        } else if (tabela[id].nSondas != nSondas) {
+            tabela[id].nSondas = nSondas;
+            salva(id);
+        }
+        trava.libera();
+        return id;
+    }
+
+    // Estação de um quadro de dados: o ID do quadro é conferido com o MAC de
+    // origem; se não bater (registro refeito, TX com ID antigo), vale o MAC
+    int localiza(uint16_t id, const uint8_t *mac) {
+        if (id < n && memcmp(tabela[id].mac, mac, 6) == 0) return id;
+        trava.bloqueia();
+        int i = buscaMac(mac);
+        trava.libera();
+        return i;
+    }
+
+    // Edição pela web: nome e/ou limites (nullptr = mantém) da estação
+    // (sonda < 0) ou de uma sonda (0 a MAX_SONDAS-1). Na sonda, nome vazio e
+    // limite HERDA_ESTACAO voltam ao padrão da estação.
+    bool edita(uint16_t id, int sonda, const char *nome, const int16_t *minCC, const int16_t *maxCC) {
+        if (id >= n || sonda >= MAX_SONDAS) return false;
+        trava.bloqueia();
+        Estacao e = tabela[id];
+        if (sonda < 0) {
+            if (nome) copiaNome(e.nome, nome, NOME_MAX);
+            if (minCC) e.minCC = *minCC;
+            if (maxCC) e.maxCC = *maxCC;
+        } else {
+            ConfigSonda &c = e.sondas[sonda];
+            if (nome) copiaNome(c.nome, nome, NOME_SONDA_MAX);
+            if (minCC) c.minCC = *minCC;
+            if (maxCC) c.maxCC = *maxCC;
+        }
+        bool ok = e.minCC <= e.maxCC && e.minCC != HERDA_ESTACAO && e.maxCC != HERDA_ESTACAO && e.nome[0] != '\0';
+        for (uint8_t s = 0; s < MAX_SONDAS; s++) ok = ok && minSonda(e, s) <= maxSonda(e, s);
+        if (ok) {
+            tabela[id] = e;
+            salva(id);
+        }
+        trava.libera();
+        return ok;
+    }
+
+    // Intervalo e heartbeat vindos no quadro; só regrava quando mudam
+    void defineJanela(uint16_t id, uint32_t intervaloS, uint16_t heartbeat) {
+        if (id >= n) return;
+        trava.bloqueia();
+        Estacao &e = tabela[id];
+        if (e.intervaloS != intervaloS || e.heartbeat != heartbeat) {
+            e.intervaloS = intervaloS;
+            e.heartbeat = heartbeat;
+            salva(id);
+        }
+        trava.libera();
+    }
+
+    // Cópia consistente (a tarefa web pode estar editando)
+    Estacao copia(uint16_t id) {
+        trava.bloqueia();
+        Estacao e = tabela[id];
+        trava.libera();
+        return e;
+    }
+
+    // Grava no arquivo as estações pendentes; o arquivo fica fora da trava
+    void persiste() {
+        if (!pendente) return;
+        pendente = false;   // antes de varrer: marca feita durante a varredura fica para a próxima
+        for (uint16_t w = 0; w < sizeof(pendentes) / sizeof(pendentes[0]); w++) {
+            for (;;) {
+                trava.bloqueia();
+                uint32_t bits = pendentes[w];
+                if (!bits) { trava.libera(); break; }
+                uint16_t id = w * 32 + __builtin_ctz(bits);
+                pendentes[w] = bits & (bits - 1);
+                Estacao e = tabela[id];
+                trava.libera();
+                Armazenamento::escreve(REGISTRO_PATH, sizeof(CabecalhoRegistro) + (uint32_t)id * sizeof(Estacao), &e, sizeof(Estacao));
+            }
+        }
+    }
+
+    uint16_t total() const { return n; }
+
+private:
+    Estacao tabela[MAX_ESTACOES];
+    uint16_t indice[TAM_INDICE];   // ID por posição de hash do MAC (0xFFFF = vazio)
+    volatile uint16_t n = 0;
+    uint32_t pendentes[(MAX_ESTACOES + 31) / 32] = {};   // bit por ID a regravar
+    volatile bool pendente = false;
+    typename Armazenamento::Trava trava;   // no ESP32, ingestão e servidor web rodam em tarefas diferentes
+
+    // FNV-1a dos 6 bytes do MAC
+    static uint16_t hashMac(const uint8_t *mac) {
+        uint32_t h = 2166136261UL;
+        for (uint8_t i = 0; i < 6; i++) { h ^= mac[i]; h *= 16777619UL; }
+        return (uint16_t)(h ^ (h >> 16)) & (TAM_INDICE - 1);
+    }
+
+    void indexa(uint16_t id) {
+        uint16_t p = hashMac(tabela[id].mac);
+        while (indice[p] != 0xFFFF) p = (p + 1) & (TAM_INDICE - 1);
+        indice[p] = id;
+    }
+
+    int buscaMac(const uint8_t *mac) {
+        for (uint16_t p = hashMac(mac); indice[p] != 0xFFFF; p = (p + 1) & (TAM_INDICE - 1)) {
+            if (memcmp(tabela[indice[p]].mac, mac, 6) == 0) return indice[p];
+        }
+        return -1;
+    }
+
+    bool nomeRepetido(const char *nome, uint16_t ate) {
+        for (uint16_t i = 0; i < ate; i++) if (strcmp(tabela[i].nome, nome) == 0) return true;
+        return false;
+    }
+
+    static void herdaTudo(Estacao &e) {
+        for (uint8_t s = 0; s < MAX_SONDAS; s++) {
+            e.sondas[s].nome[0] = '\0';
+            e.sondas[s].minCC = e.sondas[s].maxCC = HERDA_ESTACAO;
+        }
+    }
+
+    // O nome entra no log ("Est: nome | Temp:"), no CSV e no JSON: sem separadores
+    static void copiaNome(char *dst, const char *src, uint8_t tam) {
+        uint8_t i = 0;
+        for (; src[i] && i < tam - 1; i++) {
+            char c = src[i];
+            dst[i] = (c < ' ' || c == '"' || c == '\\' || c == ',' || c == '|' || c == '/') ? '_' : c;
+        }
+        dst[i] = '\0';
+    }
+
+    // Marca o registro desta estação para persiste() (o arquivo é cabeçalho +
+    // tabela na ordem dos IDs); chamado com a trava
+    void salva(uint16_t id) {
+        pendentes[id / 32] |= 1UL << (id % 32);
+        pendente = true;
+    }
+};
+
+#endif // REGISTRO_ESTACOES_H
@@ -0,0 +1,125 @@
+#ifndef SINCRONIA_LOG_H
+#define SINCRONIA_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --------------------
+// Sincronia incremental do /log
+// --------------------
+// As posições são absolutas dentro da sessão do log (log_rotativo.h): o byte
+// N continua sendo o byte N depois de rotacionar, só deixa de estar
+// disponível quando o segmento antigo é descartado.
+//
+//   ETag    "<sessao>-<fim>": muda a cada linha nova e quando o log é zerado
+//   Range   bytes=a-b em posições absolutas (antes do segmento mais antigo: 416)
+//   cursor  <sessao>-<posicao>: /log?since=<cursor> devolve só o que veio
+//           depois; toda resposta traz o próximo cursor em X-Log-Cursor
+//
+// Sincronia de rotina: guarda o X-Log-Cursor e pede /log?since=<cursor>
+// (204 quando não há nada novo). X-Log-Reinicio indica que o log foi zerado e
+// a resposta voltou ao começo; X-Log-Lacuna, quantos bytes a rotação descartou
+// antes de o cliente buscá-los.
+
+#define LOG_CURSOR_MAX 24
+
+struct RespostaLog {
+    int codigo;        // 200, 204, 206, 304 ou 416
+    uint32_t de;       // trecho [de, ate) a enviar
+    uint32_t ate;
+    bool reinicio;     // cursor de outra sessão (log zerado): volta ao começo
+    uint32_t lacuna;   // bytes entre o cursor e o segmento mais antigo, já descartados
+};
+
+inline void formataCursor(char *buf, size_t tam, uint32_t sessao, uint32_t pos) {
+    snprintf(buf, tam, "%08lx-%lu", (unsigned long)sessao, (unsigned long)pos);
+}
+
+inline void formataEtag(char *buf, size_t tam, uint32_t sessao, uint32_t fim) {
+    snprintf(buf, tam, "\"%08lx-%lu\"", (unsigned long)sessao, (unsigned long)fim);
+}
+
+inline bool leCursor(const char *s, uint32_t &sessao, uint32_t &pos) {
+    char *fim;
+    unsigned long a = strtoul(s, &fim, 16);
+    if (fim == s || *fim != '-') return false;
+    const char *p = fim + 1;
+    unsigned long b = strtoul(p, &fim, 10);
+    if (fim == p || *fim != '\0') return false;
+    sessao = (uint32_t)a;
+    pos = (uint32_t)b;
+    return true;
+}
+
+// Uma única faixa: "bytes=a-b", "bytes=a-" ou "bytes=-n" (ate é exclusivo).
+// Faixas múltiplas ou malformadas retornam false e o pedido vira um GET comum.
+inline bool leRange(const char *s, uint32_t fim, uint32_t &de, uint32_t &ate) {
+    if (strncmp(s, "bytes=", 6) != 0 || strchr(s, ',')) return false;
+    const char *p = s + 6;
+    char *q;
+    if (*p == '-') {
+        unsigned long n = strtoul(p + 1, &q, 10);
+        if (q == p + 1 || *q != '\0' || n == 0) return false;
+        de = n >= fim ? 0 : fim - (uint32_t)n;
+        ate = fim;
+        return true;
+    }
+    unsigned long a = strtoul(p, &q, 10);
+    if (q == p || *q != '-') return false;
+    p = q + 1;
+    unsigned long b = fim ? fim - 1 : 0;
+    if (*p != '\0') {
+        b = strtoul(p, &q, 10);
+        if (q == p || *q != '\0' || b < a) return false;
+    }
+    de = (uint32_t)a;
+    ate = b + 1 > fim ? fim : (uint32_t)(b + 1);
+    return true;
+}
+
+// Decide a resposta do /log a partir dos parâmetros do pedido (nullptr = ausente)
+inline RespostaLog resolvePedidoLog(const char *since, const char *range, const char *ifNoneMatch,
+                                    uint32_t sessao, uint32_t inicio, uint32_t fim) {
+    RespostaLog r = { 200, inicio, fim, false, 0 };
+
+    if (since) {
+        uint32_t s, pos;
+        if (!leCursor(since, s, pos) || s != sessao || pos > fim) {
+            r.reinicio = true;             // cursor inválido ou de um log já zerado
+        } else if (pos < inicio) {
+            r.lacuna = inicio - pos;       // parte já saiu da rotação
+        } else {
+            r.de = pos;
+        }
+        if (r.de == fim) r.codigo = 204;
+        return r;
+    }
+
+    if (ifNoneMatch) {
+        char etag[LOG_CURSOR_MAX + 2];
+        formataEtag(etag, sizeof(etag), sessao, fim);
+        if (strcmp(ifNoneMatch, "*") == 0 || strstr(ifNoneMatch, etag)) {
+            r.codigo = 304;
+            r.de = r.ate = fim;
+            return r;
+        }
+    }
+
+    uint32_t de, ate;
+    if (range && leRange(range, fim, de, ate)) {
+        if (de < inicio && ate > inicio && range[6] == '-') de = inicio;   // sufixo maior que o retido
+        if (de >= fim || de < inicio) {
+            r.codigo = 416;
+            r.de = r.ate = fim;
+            return r;
+        }
+        r.codigo = 206;
+        r.de = de;
+        r.ate = ate;
+    }
+    return r;
+}
+
+#endif // SINCRONIA_LOG_H
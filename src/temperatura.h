@@ -0,0 +1,113 @@
+#ifndef TEMPERATURA_H
+#define TEMPERATURA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// --------------------
+// Temperatura em ponto fixo (centésimos de °C, int16)
+// --------------------
+// O DS18B20 entrega a leitura já em ponto fixo (1/16 °C no registrador, 1/128 °C
+// no valor "raw" da DallasTemperature). Todo o caminho quadro -> alertas -> log
+// trabalha em centésimos inteiros, sem float: o ESP8266 não tem FPU.
+
+#ifndef TEMP_MIN
+#define TEMP_MIN 5.0
+#endif
+#ifndef TEMP_MAX
+#define TEMP_MAX 10.0
+#endif
+
+#ifndef RESOLUCAO
+#define RESOLUCAO 12   // bits das sondas do transmissor (9 a 12)
+#endif
+
+#define TEMP_INVALIDA_CC INT16_MIN          // sem leitura / nada enviado ainda
+#define TEMP_DESCONECTADO_CC (-12700)       // equivale a DEVICE_DISCONNECTED_C
+#define RAW_DESCONECTADO (-7040)            // equivale a DEVICE_DISCONNECTED_RAW
+
+// Conversão em tempo de compilação para limites vindos do platformio.ini
+constexpr int16_t centiDeGraus(double graus) {
+    return (int16_t)(graus * 100.0 + (graus < 0 ? -0.5 : 0.5));
+}
+
+constexpr int16_t TEMP_MIN_CC = centiDeGraus(TEMP_MIN);
+constexpr int16_t TEMP_MAX_CC = centiDeGraus(TEMP_MAX);
+
+// raw (1/128 °C) -> centésimos, arredondando metade para longe do zero
+// (mesmo resultado de round(temp * 100.0) / 100.0)
+inline int16_t rawParaCenti(int32_t raw) {
+    if (raw <= RAW_DESCONECTADO) return TEMP_DESCONECTADO_CC;
+    int32_t n = raw * 100;
+    return (int16_t)(n >= 0 ? (n + 64) >> 7 : -((-n + 64) >> 7));
+}
+
+// Formata "-12.34" em buf (mínimo 8 bytes); retorna o número de caracteres
+inline int formatCenti(char *buf, size_t len, int16_t cc) {
+    int32_t v = cc;
+    const char *sinal = "";
+    if (v < 0) { sinal = "-"; v = -v; }
+    return snprintf(buf, len, "%s%ld.%02ld", sinal, (long)(v / 100), (long)(v % 100));
+}
+
+// "-4.5", "8", "12.25" -> centésimos (sem float); false se não for um número
+// com até duas casas decimais dentro da faixa do int16
+inline bool textoParaCenti(const char *s, int16_t &cc) {
+    bool negativo = *s == '-';
+    if (*s == '-' || *s == '+') s++;
+    if (*s < '0' || *s > '9') return false;
+    int32_t v = 0;
+    while (*s >= '0' && *s <= '9') {
+        v = v * 10 + (*s++ - '0');
+        if (v > 400) return false;   // bem além de qualquer sonda
+    }
+    v *= 100;
+    if (*s == '.' || *s == ',') {
+        s++;
+        if (*s >= '0' && *s <= '9') v += (*s++ - '0') * 10;
+        if (*s >= '0' && *s <= '9') v += (*s++ - '0');
+    }
+    if (*s != '\0') return false;
+    cc = (int16_t)(negativo ? -v : v);
+    return true;
+}
+
+#ifdef DallasTemperature_h
+// Lê o sensor do índice informado direto do valor raw (sem getTempC)
+inline int16_t lerCentiPorIndice(DallasTemperature &dallas, uint8_t indice) {
+    DeviceAddress addr;
+    if (!dallas.getAddress(addr, indice)) return TEMP_DESCONECTADO_CC;
+    return rawParaCenti(dallas.getTemp(addr));
+}
+
+// Busca OneWire completa: guarda até max ROM IDs e fixa a resolução em RESOLUCAO bits
+inline uint8_t enumeraSondas(DallasTemperature &dallas, uint8_t rom[][8], uint8_t max) {
+    dallas.begin();
+    uint8_t n = 0;
+    uint8_t total = dallas.getDeviceCount();
+    for (uint8_t i = 0; i < total && n < max; i++) {
+        if (dallas.getAddress(rom[n], i)) {
+            dallas.setResolution(rom[n], RESOLUCAO);
+            n++;
+        }
+    }
+    return n;
+}
+
+// Uma única conversão simultânea (Skip ROM + Convert T) e leitura de cada sonda
+// pelo ROM ID em cache, sem refazer a busca no barramento.
+// Retorna false se alguma sonda não respondeu (o cache deve ser refeito).
+inline bool lerSondas(DallasTemperature &dallas, const uint8_t rom[][8], uint8_t n, int16_t *temps) {
+    dallas.setWaitForConversion(false);
+    dallas.requestTemperatures();
+    delay(dallas.millisToWaitForConversion(RESOLUCAO));
+    bool ok = true;
+    for (uint8_t i = 0; i < n; i++) {
+        temps[i] = rawParaCenti(dallas.getTemp(rom[i]));
+        if (temps[i] == TEMP_DESCONECTADO_CC) ok = false;
+    }
+    return ok;
+}
+#endif
+
+#endif // TEMPERATURA_H
@@ -0,0 +1,748 @@
+// --------------------
+// Análise de logs em lote (host)
+// --------------------
+// Lê os log.txt recolhidos dos SDs (um ou vários arquivos, anos de dados)
+// mapeados em memória e divididos em blocos lidos em paralelo. Cada bloco
+// começa na primeira linha inteira depois do corte. O leitor é feito à mão:
+// data em posições fixas, temperatura direto em centésimos (sem float) e busca
+// de fim de linha com SSE2 quando o compilador tem. Depois os blocos são
+// juntados em ordem, uma série por estação/sonda.
+//
+// Saídas:
+//   resumo na tela (e em --resumo arq.csv): amostras, faixa, média, tempo
+//       acima/abaixo dos limites, excursões, alertas e faltantes por estação
+//   --excursoes arq.csv: cada saída da faixa, com início, fim, tempo fora e pico
+//   --colunas DIR: série de cada estação em colunas binárias little-endian
+//       (DIR/<nome>.t = uint32 segundos desde 1970 na hora do RTC, DIR/<nome>.cc
+//       = int16 centésimos de °C) para numpy.fromfile, mais DIR/estacoes.csv
+//
+// Limites: os do próprio log, por sonda (linhas "Estacao N sonda K editada" e
+// marcas de ALERTA, vale o mais recente); sem nenhum, TEMP_MIN/TEMP_MAX;
+// --min/--max sobrepõem.
+// Entre duas amostras vale a anterior (o TX só transmite quando muda ou no
+// heartbeat) até --lacuna segundos ou uma linha "Estacao faltante". O
+// receptor escreve uma por subcanal, com o nome da série ("Garrafa1/2" ou o
+// nome dado à sonda), então cada série fecha pela sua própria linha.
+// Passe os arquivos em ordem cronológica (log.1 antes de log.txt).
+//
+// Compilar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -pthread -Isrc tools/analise_log.cpp -o analise_log
+// Exemplos:
+//   ./analise_log log.1 log.txt
+//   ./analise_log -j 8 --excursoes exc.csv --colunas colunas/ site3/log.txt
+//   ./analise_log gera sintetico.txt 1024     (log sintético de 1024 MB)
+//   ./analise_log bench 512 [threads]         (MB/s com 1, 2, 4... threads, em memória)
+//
+// O bench também compara com uma leitura ingênua (sscanf + strstr) e sai com
+// código 1 se o resultado mudar com o número de threads.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define TEMP_MIN 0
+#define TEMP_MAX 10
+#include "temperatura.h"
+
+#define BLOCO_MIN (1u << 20)      // blocos de 1 a 64 MB, ~4 por thread
+#define BLOCO_MAX (64u << 20)
+#define LACUNA_PADRAO 3600        // s: silêncio maior que isso não conta como "valor mantido"
+#define NOME_AMBIENTE "(ambiente)"
+#define DATA_MAX 32               // folga para o snprintf; a data usa 19 + '\0'
+
+using Relogio = std::chrono::steady_clock;
+
+static double segundosDesde(Relogio::time_point t0) {
+    return std::chrono::duration<double>(Relogio::now() - t0).count();
+}
+
+// --------------------
+// Datas (hora local do RTC tratada como UTC, sem fuso)
+// --------------------
+// Dias desde 01/01/1970 no calendário gregoriano (algoritmo de H. Hinnant)
+static int64_t diasDesde1970(int a, unsigned m, unsigned d) {
+    a -= m <= 2;
+    const int era = (a >= 0 ? a : a - 399) / 400;
+    const unsigned aDaEra = (unsigned)(a - era * 400);
+    const unsigned diaDoAno = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned diaDaEra = aDaEra * 365 + aDaEra / 4 - aDaEra / 100 + diaDoAno;
+    return era * 146097LL + (int64_t)diaDaEra - 719468;
+}
+
+// "dd/mm/aaaa hh:mm:ss" (buf com DATA_MAX bytes), mesmo formato do log
+static void formataData(char *buf, uint32_t t) {
+    int64_t z = t / 86400 + 719468;
+    uint32_t s = t % 86400;
+    const int64_t era = z / 146097;
+    const unsigned diaDaEra = (unsigned)(z - era * 146097);
+    const unsigned aDaEra = (diaDaEra - diaDaEra / 1460 + diaDaEra / 36524 - diaDaEra / 146096) / 365;
+    const unsigned diaDoAno = diaDaEra - (365 * aDaEra + aDaEra / 4 - aDaEra / 100);
+    const unsigned mp = (5 * diaDoAno + 2) / 153;
+    const unsigned d = diaDoAno - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int a = (int)(aDaEra + era * 400) + (m <= 2);
+    snprintf(buf, DATA_MAX, "%02u/%02u/%04d %02u:%02u:%02u", d, m, a, s / 3600, s / 60 % 60, s % 60);
+}
+
+static inline unsigned dig(char c) { return (unsigned)(c - '0'); }
+
+// As linhas de um bloco têm quase sempre a mesma data: guarda a última
+struct CacheData {
+    char texto[10] = {};
+    int64_t dias = -1;
+};
+
+// "dd/mm/aaaa hh:mm:ss" no começo da linha -> segundos desde 1970
+static bool leData(const char *p, const char *fim, CacheData &cache, uint32_t &t) {
+    if (fim - p < 19 || p[2] != '/' || p[5] != '/' || p[10] != ' ' || p[13] != ':' || p[16] != ':') return false;
+    static const uint8_t POS[] = { 0, 1, 3, 4, 6, 7, 8, 9, 11, 12, 14, 15, 17, 18 };
+    for (uint8_t i : POS) if (dig(p[i]) > 9) return false;
+    if (cache.dias < 0 || memcmp(cache.texto, p, 10) != 0) {
+        unsigned d = dig(p[0]) * 10 + dig(p[1]), m = dig(p[3]) * 10 + dig(p[4]);
+        int a = dig(p[6]) * 1000 + dig(p[7]) * 100 + dig(p[8]) * 10 + dig(p[9]);
+        if (d < 1 || d > 31 || m < 1 || m > 12 || a < 1970 || a > 2105) return false;   // RTC sem bateria grava lixo
+        memcpy(cache.texto, p, 10);
+        cache.dias = diasDesde1970(a, m, d);
+    }
+    unsigned h = dig(p[11]) * 10 + dig(p[12]), mi = dig(p[14]) * 10 + dig(p[15]), s = dig(p[17]) * 10 + dig(p[18]);
+    if (h > 23 || mi > 59 || s > 59) return false;
+    t = (uint32_t)(cache.dias * 86400 + h * 3600 + mi * 60 + s);
+    return true;
+}
+
+// "-3.25" / "4,5" / "8" -> centésimos; retorna o ponteiro depois do número ou nullptr
+static const char *leCenti(const char *p, const char *fim, int16_t &cc) {
+    bool negativo = p < fim && *p == '-';
+    if (negativo) p++;
+    if (p >= fim || dig(*p) > 9) return nullptr;
+    int32_t v = 0;
+    while (p < fim && dig(*p) <= 9) {
+        v = v * 10 + dig(*p++);
+        if (v > 400) return nullptr;
+    }
+    v *= 100;
+    if (p < fim && (*p == '.' || *p == ',')) {
+        p++;
+        if (p < fim && dig(*p) <= 9) v += dig(*p++) * 10;
+        if (p < fim && dig(*p) <= 9) v += dig(*p++);
+    }
+    cc = (int16_t)(negativo ? -v : v);
+    return p;
+}
+
+static inline bool comeca(const char *p, const char *fim, const char *lit, size_t n) {
+    return (size_t)(fim - p) >= n && memcmp(p, lit, n) == 0;
+}
+#define COMECA(p, fim, lit) comeca(p, fim, lit, sizeof(lit) - 1)
+
+// Próximo '\n' (ou fim): 16 bytes por vez com SSE2, o resto com memchr
+static inline const char *fimDaLinha(const char *p, const char *fim) {
+#if defined(__SSE2__)
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (fim - p >= 16) {
+        int m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), nl));
+        if (m) return p + __builtin_ctz(m);
+        p += 16;
+    }
+#endif
+    const char *q = (const char*)memchr(p, '\n', fim - p);
+    return q ? q : fim;
+}
+
+// --------------------
+// Séries (colunas por estação)
+// --------------------
+struct Serie {
+    std::vector<uint32_t> t;       // segundos desde 1970
+    std::vector<int16_t> cc;       // centésimos de °C
+    std::vector<uint32_t> faltas;  // instantes sem dado ("Estacao faltante", sonda desconectada)
+    int16_t minCC = 0, maxCC = 0;  // limites mais recentes vistos no log
+    uint64_t ordemMin = 0, ordemMax = 0;   // posição da linha que os definiu (0 = nunca)
+    uint32_t alertas = 0, normalizados = 0, faltantes = 0, desconectadas = 0;
+};
+
+// Resultado da leitura de um bloco; os nomes apontam para o arquivo mapeado
+struct Bloco {
+    const char *ini, *fim;
+    uint64_t base;                 // ordem global das linhas deste bloco
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> nomes;
+    std::vector<Serie> series;
+    uint32_t tUltimo = 0;          // última data vista no bloco
+    uint64_t linhas = 0, ignoradas = 0;
+    CacheData cache;
+
+    uint32_t serie(std::string_view nome) {
+        auto it = ids.find(nome);
+        if (it != ids.end()) return it->second;
+        uint32_t id = (uint32_t)series.size();
+        ids.emplace(nome, id);
+        nomes.push_back(nome);
+        series.emplace_back();
+        return id;
+    }
+
+    void leLinha(const char *p, const char *e) {
+        linhas++;
+        uint64_t ordem = base + linhas;
+        uint32_t t;
+        if (leData(p, e, cache, t)) {
+            tUltimo = t;
+            const char *q = p + 19;
+            if (COMECA(q, e, " - Est: ")) {
+                q += 8;
+                const char *barra = (const char*)memchr(q, '|', e - q);
+                int16_t v;
+                const char *r;
+                if (!barra || barra == q || !COMECA(barra - 1, e, " | Temp: ") ||
+                    !(r = leCenti(barra + 8, e, v))) { ignoradas++; return; }
+                Serie &s = series[serie(std::string_view(q, barra - 1 - q))];
+                if (v == TEMP_DESCONECTADO_CC) {
+                    s.desconectadas++;
+                    s.faltas.push_back(t);
+                } else {
+                    s.t.push_back(t);
+                    s.cc.push_back(v);
+                }
+                const char *marca = (const char*)memchr(r, '<', e - r);
+                if (!marca) return;
+                int16_t limite;
+                if (COMECA(marca, e, "<<< ALERTA: abaixo de ") && leCenti(marca + 22, e, limite)) {
+                    s.alertas++;
+                    s.minCC = limite;
+                    s.ordemMin = ordem;
+                } else if (COMECA(marca, e, "<<< ALERTA: acima de ") && leCenti(marca + 21, e, limite)) {
+                    s.alertas++;
+                    s.maxCC = limite;
+                    s.ordemMax = ordem;
+                } else if (COMECA(marca, e, "<<< NORMALIZADO")) {
+                    s.normalizados++;
+                }
+                return;
+            }
+            int16_t v;
+            if (COMECA(q, e, " - Ambiente: ") && leCenti(q + 13, e, v)) {
+                Serie &s = series[serie(NOME_AMBIENTE)];
+                if (v == TEMP_DESCONECTADO_CC) { s.desconectadas++; return; }
+                s.t.push_back(t);
+                s.cc.push_back(v);
+                return;
+            }
+            ignoradas++;
+            return;
+        }
+
+        // Linhas sem data: valem no instante da última linha datada.
+        // "Estacao faltante: Garrafa1/2" fecha só a série daquele subcanal
+        if (COMECA(p, e, "Estacao faltante: ")) {
+            Serie &s = series[serie(std::string_view(p + 18, e - p - 18))];
+            s.faltantes++;
+            s.faltas.push_back(tUltimo);   // 0 = antes da 1ª data do bloco, resolvido na junção
+            return;
+        }
+        // "Estacao 3 sonda 2 editada: Geladeira2/2 [2.50, 8.00]": limites em vigor
+        // da série daquela sonda
+        if (COMECA(p, e, "Estacao ") && dig(p[8]) <= 9) {
+            const char *q = p + 8;
+            while (q < e && dig(*q) <= 9) q++;
+            bool sonda = COMECA(q, e, " sonda ") && q + 7 < e && dig(q[7]) <= 9;
+            if (sonda) for (q += 7; q < e && dig(*q) <= 9; q++) {}
+            const char *colchete = (const char*)memrchr(q, '[', e - q);
+            int16_t minCC, maxCC;
+            const char *r;
+            if (sonda && COMECA(q, e, " editada: ") && colchete && colchete - q > 11 &&
+                (r = leCenti(colchete + 1, e, minCC)) && COMECA(r, e, ", ") && leCenti(r + 2, e, maxCC)) {
+                Serie &s = series[serie(std::string_view(q + 10, colchete - 1 - (q + 10)))];
+                s.minCC = minCC;
+                s.maxCC = maxCC;
+                s.ordemMin = s.ordemMax = ordem;
+                return;
+            }
+        }
+        if (!COMECA(p, e, "-----") && !COMECA(p, e, "Estacao pareada: ") && !COMECA(p, e, "Registro cheio")) ignoradas++;
+    }
+
+    void le() {
+        for (const char *p = ini; p < fim; ) {
+            const char *nl = fimDaLinha(p, fim);
+            const char *e = nl;
+            if (e > p && e[-1] == '\r') e--;
+            if (e > p) leLinha(p, e);
+            p = nl + 1;
+        }
+    }
+};
+
+// Todas as séries, já juntadas na ordem dos arquivos
+struct Base {
+    std::vector<std::string> nomes;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<Serie> series;
+    uint64_t linhas = 0, ignoradas = 0, bytes = 0;
+};
+
+// Roda f(i) para i em [0, n) com nThreads threads pegando o próximo índice livre
+template <typename F>
+static void paraCada(unsigned nThreads, size_t n, F f) {
+    std::atomic<size_t> proximo{ 0 };
+    auto trabalha = [&]() { for (size_t i; (i = proximo++) < n; ) f(i); };
+    std::vector<std::thread> ts;
+    for (unsigned k = 1; k < nThreads && k < n; k++) ts.emplace_back(trabalha);
+    trabalha();
+    for (auto &t : ts) t.join();
+}
+
+struct Fonte {
+    const char *dados;
+    size_t tam;
+};
+
+static void junta(Base &base, std::vector<Bloco> &blocos) {
+    uint32_t tAnterior = 0;
+    for (Bloco &b : blocos) {
+        base.linhas += b.linhas;
+        base.ignoradas += b.ignoradas;
+        for (size_t i = 0; i < b.series.size(); i++) {
+            std::string nome(b.nomes[i]);
+            auto it = base.ids.find(nome);
+            if (it == base.ids.end()) {
+                it = base.ids.emplace(nome, (uint32_t)base.series.size()).first;
+                base.nomes.push_back(nome);
+                base.series.emplace_back();
+            }
+            Serie &g = base.series[it->second];
+            Serie &s = b.series[i];
+            g.t.insert(g.t.end(), s.t.begin(), s.t.end());
+            g.cc.insert(g.cc.end(), s.cc.begin(), s.cc.end());
+            for (uint32_t f : s.faltas) {
+                if (f == 0) f = tAnterior;
+                if (f) g.faltas.push_back(f);
+            }
+            if (s.ordemMin > g.ordemMin) { g.minCC = s.minCC; g.ordemMin = s.ordemMin; }
+            if (s.ordemMax > g.ordemMax) { g.maxCC = s.maxCC; g.ordemMax = s.ordemMax; }
+            g.alertas += s.alertas;
+            g.normalizados += s.normalizados;
+            g.faltantes += s.faltantes;
+            g.desconectadas += s.desconectadas;
+            s = Serie();   // libera as colunas do bloco já copiadas
+        }
+        if (b.tUltimo) tAnterior = b.tUltimo;
+    }
+}
+
+// Divide as fontes em blocos terminados em '\n', lê em paralelo e junta
+static Base analisa(const std::vector<Fonte> &fontes, unsigned nThreads) {
+    Base base;
+    std::vector<Bloco> blocos;
+    for (const Fonte &f : fontes) {
+        base.bytes += f.tam;
+        size_t alvo = std::min<size_t>(BLOCO_MAX, std::max<size_t>(BLOCO_MIN, f.tam / (nThreads * 4) + 1));
+        for (size_t ini = 0; ini < f.tam; ) {
+            size_t fim = std::min(f.tam, ini + alvo);
+            if (fim < f.tam) fim = std::min(f.tam, (size_t)(fimDaLinha(f.dados + fim, f.dados + f.tam) - f.dados) + 1);
+            Bloco b;
+            b.ini = f.dados + ini;
+            b.fim = f.dados + fim;
+            b.base = (uint64_t)(blocos.size() + 1) << 32;
+            blocos.push_back(std::move(b));
+            ini = fim;
+        }
+    }
+    paraCada(nThreads, blocos.size(), [&](size_t i) { blocos[i].le(); });
+    junta(base, blocos);
+    return base;
+}
+
+// --------------------
+// Relatórios
+// --------------------
+struct Excursao {
+    uint32_t estacao;
+    int lado;            // +1 acima do máximo, -1 abaixo do mínimo
+    uint32_t ini, fim;   // da primeira amostra fora até a primeira de volta (ou fim do valor mantido)
+    uint32_t foraS;      // tempo efetivamente coberto por amostras fora
+    int16_t pico;
+    uint32_t amostras;
+};
+
+struct Resumo {
+    int16_t minCC, maxCC;        // limites usados
+    int16_t menor = INT16_MAX, maior = INT16_MIN;
+    double media = 0;
+    uint64_t cobertoS = 0, acimaS = 0, abaixoS = 0;
+    uint32_t recuos = 0;         // data voltando (RTC acertado ou arquivos fora de ordem)
+    std::vector<Excursao> excursoes;
+};
+
+static Resumo resume(const Serie &s, uint32_t id, int16_t minCC, int16_t maxCC, uint32_t lacuna, bool comExcursoes) {
+    Resumo r;
+    r.minCC = minCC;
+    r.maxCC = maxCC;
+    size_t n = s.t.size(), j = 0;
+    int64_t soma = 0;
+    Excursao atual = {};
+    bool aberta = false;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t t0 = s.t[i];
+        int16_t v = s.cc[i];
+        soma += v;
+        r.menor = std::min(r.menor, v);
+        r.maior = std::max(r.maior, v);
+
+        // Valor mantido até a próxima amostra, a lacuna máxima ou uma falta
+        uint64_t ate = t0;
+        if (i + 1 < n) {
+            if (s.t[i + 1] < t0) r.recuos++;
+            else ate = std::min<uint64_t>(s.t[i + 1], (uint64_t)t0 + lacuna);
+        }
+        while (j < s.faltas.size() && s.faltas[j] < t0) j++;
+        if (j < s.faltas.size() && s.faltas[j] < ate) ate = s.faltas[j];
+        uint32_t dur = (uint32_t)(ate - t0);
+        r.cobertoS += dur;
+
+        int lado = !comExcursoes ? 0 : v < minCC ? -1 : (v > maxCC ? 1 : 0);
+        if (lado > 0) r.acimaS += dur;
+        if (lado < 0) r.abaixoS += dur;
+        if (aberta && lado != atual.lado) {
+            atual.fim = t0;
+            r.excursoes.push_back(atual);
+            aberta = false;
+        }
+        if (lado && !aberta) {
+            atual = { id, lado, t0, t0, 0, v, 0 };
+            aberta = true;
+        }
+        if (aberta) {
+            atual.foraS += dur;
+            atual.amostras++;
+            atual.fim = (uint32_t)ate;
+            atual.pico = lado > 0 ? std::max(atual.pico, v) : std::min(atual.pico, v);
+        }
+    }
+    if (aberta) r.excursoes.push_back(atual);
+    if (n) r.media = (double)soma / n / 100.0;
+    return r;
+}
+
+// Limites de uma série: os mais recentes dela (cada sonda tem os seus e a
+// edição da estação gera uma linha por sonda); sem nenhum, TEMP_MIN/TEMP_MAX
+static void limitesDe(const Base &base, uint32_t id, int16_t &minCC, int16_t &maxCC) {
+    const Serie &s = base.series[id];
+    minCC = s.ordemMin ? s.minCC : TEMP_MIN_CC;
+    maxCC = s.ordemMax ? s.maxCC : TEMP_MAX_CC;
+}
+
+static std::string centi(int16_t cc) {
+    char buf[8];
+    formatCenti(buf, sizeof(buf), cc);
+    return buf;
+}
+
+static std::string data(uint32_t t) {
+    char buf[DATA_MAX];
+    formataData(buf, t);
+    return buf;
+}
+
+// Nome de estação -> nome de arquivo ("Garrafa1/2" -> "Garrafa1_2")
+static std::string nomeArquivo(const std::string &nome) {
+    std::string r = nome;
+    for (char &c : r) if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') c = '_';
+    return r;
+}
+
+static bool gravaColunas(const char *dir, const Base &base, const std::vector<Resumo> &resumos) {
+    mkdir(dir, 0755);
+    std::string indice = std::string(dir) + "/estacoes.csv";
+    FILE *idx = fopen(indice.c_str(), "w");
+    if (!idx) { perror(indice.c_str()); return false; }
+    fprintf(idx, "estacao,arquivo,amostras,inicio,fim,min,max\n");
+    for (size_t i = 0; i < base.series.size(); i++) {
+        const Serie &s = base.series[i];
+        if (s.t.empty()) continue;
+        std::string arq = nomeArquivo(base.nomes[i]);
+        for (int k = 0; k < 2; k++) {
+            std::string caminho = std::string(dir) + "/" + arq + (k ? ".cc" : ".t");
+            FILE *f = fopen(caminho.c_str(), "wb");
+            if (!f) { perror(caminho.c_str()); fclose(idx); return false; }
+            if (k) fwrite(s.cc.data(), sizeof(int16_t), s.cc.size(), f);
+            else fwrite(s.t.data(), sizeof(uint32_t), s.t.size(), f);
+            fclose(f);
+        }
+        fprintf(idx, "%s,%s,%zu,%s,%s,%s,%s\n", base.nomes[i].c_str(), arq.c_str(), s.t.size(),
+                data(s.t.front()).c_str(), data(s.t.back()).c_str(),
+                centi(resumos[i].minCC).c_str(), centi(resumos[i].maxCC).c_str());
+    }
+    fclose(idx);
+    return true;
+}
+
+static std::vector<Resumo> relatorios(const Base &base, unsigned nThreads, uint32_t lacuna,
+                                      const int16_t *minFixo, const int16_t *maxFixo) {
+    std::vector<Resumo> resumos(base.series.size());
+    paraCada(nThreads, base.series.size(), [&](size_t i) {
+        int16_t minCC, maxCC;
+        limitesDe(base, (uint32_t)i, minCC, maxCC);
+        if (minFixo) minCC = *minFixo;
+        if (maxFixo) maxCC = *maxFixo;
+        resumos[i] = resume(base.series[i], (uint32_t)i, minCC, maxCC, lacuna, base.nomes[i] != NOME_AMBIENTE);
+    });
+    return resumos;
+}
+
+static void imprimeResumo(FILE *f, bool csv, const Base &base, const std::vector<Resumo> &resumos) {
+    if (csv) fprintf(f, "estacao,amostras,inicio,fim,menor,maior,media,min,max,coberto_h,acima_h,abaixo_h,excursoes,alertas,faltantes,desconectadas,recuos\n");
+    else fprintf(f, "%-18s %9s %-19s %-19s %7s %7s %7s %15s %8s %8s %8s %5s %6s %6s\n", "estacao", "amostras", "inicio", "fim",
+                 "menor", "maior", "media", "limites", "coberto", "acima", "abaixo", "exc", "alerta", "falta");
+    std::vector<size_t> ordem(base.series.size());
+    for (size_t i = 0; i < ordem.size(); i++) ordem[i] = i;
+    std::sort(ordem.begin(), ordem.end(), [&](size_t a, size_t b) { return base.nomes[a] < base.nomes[b]; });
+    for (size_t i : ordem) {
+        const Serie &s = base.series[i];
+        const Resumo &r = resumos[i];
+        if (s.t.empty() && !s.faltantes) continue;
+        std::string ini = s.t.empty() ? "-" : data(s.t.front()), fim = s.t.empty() ? "-" : data(s.t.back());
+        std::string menor = s.t.empty() ? "-" : centi(r.menor), maior = s.t.empty() ? "-" : centi(r.maior);
+        double h = 3600.0;
+        if (csv) {
+            fprintf(f, "%s,%zu,%s,%s,%s,%s,%.2f,%s,%s,%.2f,%.2f,%.2f,%zu,%u,%u,%u,%u\n", base.nomes[i].c_str(), s.t.size(),
+                    ini.c_str(), fim.c_str(), menor.c_str(), maior.c_str(), r.media, centi(r.minCC).c_str(), centi(r.maxCC).c_str(),
+                    r.cobertoS / h, r.acimaS / h, r.abaixoS / h, r.excursoes.size(), s.alertas, s.faltantes, s.desconectadas, r.recuos);
+        } else {
+            std::string limites = base.nomes[i] == NOME_AMBIENTE ? "-" : "[" + centi(r.minCC) + ", " + centi(r.maxCC) + "]";
+            double pAcima = r.cobertoS ? 100.0 * r.acimaS / r.cobertoS : 0, pAbaixo = r.cobertoS ? 100.0 * r.abaixoS / r.cobertoS : 0;
+            fprintf(f, "%-18s %9zu %-19s %-19s %7s %7s %7.2f %15s %7.1fh %7.1f%% %7.1f%% %5zu %6u %6u\n", base.nomes[i].c_str(), s.t.size(),
+                    ini.c_str(), fim.c_str(), menor.c_str(), maior.c_str(), r.media, limites.c_str(),
+                    r.cobertoS / h, pAcima, pAbaixo, r.excursoes.size(), s.alertas, s.faltantes);
+        }
+    }
+}
+
+static bool gravaExcursoes(const char *caminho, const Base &base, const std::vector<Resumo> &resumos) {
+    FILE *f = fopen(caminho, "w");
+    if (!f) { perror(caminho); return false; }
+    fprintf(f, "estacao,lado,inicio,fim,duracao_s,fora_s,pico,limite,amostras\n");
+    for (const Resumo &r : resumos) {
+        for (const Excursao &e : r.excursoes) {
+            fprintf(f, "%s,%s,%s,%s,%u,%u,%s,%s,%u\n", base.nomes[e.estacao].c_str(), e.lado > 0 ? "acima" : "abaixo",
+                    data(e.ini).c_str(), data(e.fim).c_str(), e.fim - e.ini, e.foraS, centi(e.pico).c_str(),
+                    centi(e.lado > 0 ? r.maxCC : r.minCC).c_str(), e.amostras);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+// --------------------
+// Log sintético e benchmark
+// --------------------
+// Blocos como os do receptor: ambiente, uma linha por estação/sonda (com as
+// marcas de alerta do logStation), faltantes e o separador, a cada 60 s.
+template <typename Saida>
+static void geraLog(Saida escreve, uint64_t bytes, int nEstacoes, uint32_t semente) {
+    struct Canal { std::string nome; int32_t cc; bool baixo, alto; int silencio; };
+    std::mt19937 rng(semente);
+    std::vector<Canal> canais;
+    for (int i = 0; i < nEstacoes; i++) {
+        std::string nome = (i % 3 == 0 ? "Garrafa" : i % 3 == 1 ? "Isopor" : "Botuflex") + std::to_string(i / 3 + 1);
+        canais.push_back({ nome, 500, false, false, 0 });
+        if (i % 4 == 0) canais.push_back({ nome + "/2", 450, false, false, 0 });
+    }
+    uint32_t t = (uint32_t)(diasDesde1970(2023, 1, 1) * 86400);
+    char linha[160], quando[DATA_MAX];
+    uint64_t escritos = 0;
+    auto poe = [&](int n) { escreve(linha, (size_t)n); escritos += n; };
+    while (escritos < bytes) {
+        formataData(quando, t);
+        int32_t ambiente = 2200 + (int32_t)(rng() % 600);
+        poe(snprintf(linha, sizeof(linha), "%s - Ambiente: %s °C\r\n", quando, centi(ambiente).c_str()));
+        for (Canal &c : canais) {
+            if (rng() % 100 < 8) { c.silencio++; continue; }   // não mudou ou perdeu o quadro
+            c.silencio = 0;
+            c.cc += (int32_t)(rng() % 41) - 20;
+            if (rng() % 2000 == 0) c.cc += 700;                  // porta aberta
+            c.cc += (500 - c.cc) / 50;
+            c.cc = std::max(-500, std::min(3000, c.cc));
+            int n = snprintf(linha, sizeof(linha), "%s - Est: %s | Temp: %s °C", quando, c.nome.c_str(), centi(c.cc).c_str());
+            if (c.cc < TEMP_MIN_CC && !c.baixo) {
+                n += snprintf(linha + n, sizeof(linha) - n, " <<< ALERTA: abaixo de %s °C!", centi(TEMP_MIN_CC).c_str());
+                c.baixo = true; c.alto = false;
+            } else if (c.cc > TEMP_MAX_CC && !c.alto) {
+                n += snprintf(linha + n, sizeof(linha) - n, " <<< ALERTA: acima de %s °C", centi(TEMP_MAX_CC).c_str());
+                c.alto = true; c.baixo = false;
+            } else if (c.cc >= TEMP_MIN_CC && c.cc <= TEMP_MAX_CC) {
+                if (c.baixo || c.alto) n += snprintf(linha + n, sizeof(linha) - n, " <<< NORMALIZADO");
+                c.baixo = c.alto = false;
+            }
+            n += snprintf(linha + n, sizeof(linha) - n, "\r\n");
+            poe(n);
+        }
+        for (Canal &c : canais) {
+            if (c.silencio > 10) poe(snprintf(linha, sizeof(linha), "Estacao faltante: %s\r\n", c.nome.c_str()));
+        }
+        poe(snprintf(linha, sizeof(linha), "--------------------------------------\r\n"));
+        t += 60;
+    }
+}
+
+// Leitura ingênua, como a do tools/energia.cpp (sscanf + strstr + atof), para comparar
+static uint64_t leituraIngenua(const std::string &dados) {
+    uint64_t amostras = 0;
+    std::string linha;
+    for (size_t p = 0; p < dados.size(); ) {
+        size_t nl = dados.find('\n', p);
+        if (nl == std::string::npos) nl = dados.size();
+        linha.assign(dados, p, nl - p);
+        p = nl + 1;
+        int d, mo, a, h, mi, se;
+        const char *est = strstr(linha.c_str(), " - Est: ");
+        if (!est || sscanf(linha.c_str(), "%d/%d/%d %d:%d:%d", &d, &mo, &a, &h, &mi, &se) != 6) continue;
+        const char *temp = strstr(est, " | Temp: ");
+        if (temp && atof(temp + 9) > -127) amostras++;
+    }
+    return amostras;
+}
+
+static uint64_t totalAmostras(const Base &base) {
+    uint64_t n = 0;
+    for (size_t i = 0; i < base.series.size(); i++) if (base.nomes[i] != NOME_AMBIENTE) n += base.series[i].t.size();
+    return n;
+}
+
+static int bench(uint64_t mb, unsigned maxThreads) {
+    std::string dados;
+    dados.reserve(mb << 20 | 4096);
+    auto t0 = Relogio::now();
+    geraLog([&](const char *p, size_t n) { dados.append(p, n); }, mb << 20, 30, 1);
+    printf("log sintético: %.1f MB em %.1f s\n", dados.size() / 1048576.0, segundosDesde(t0));
+
+    std::string amostra = dados.substr(0, std::min<size_t>(dados.size(), 64u << 20));
+    t0 = Relogio::now();
+    uint64_t ingenuas = leituraIngenua(amostra);
+    double s = segundosDesde(t0);
+    printf("%-22s %8.1f MB/s  (%llu amostras em %.1f MB)\n", "ingênua, 1 thread", amostra.size() / 1048576.0 / s,
+           (unsigned long long)ingenuas, amostra.size() / 1048576.0);
+
+    uint64_t referencia = 0;
+    for (unsigned n = 1; ; n = std::min(n * 2, maxThreads)) {
+        t0 = Relogio::now();
+        Base base = analisa({ { dados.data(), dados.size() } }, n);
+        double leitura = segundosDesde(t0);
+        std::vector<Resumo> resumos = relatorios(base, n, LACUNA_PADRAO, nullptr, nullptr);
+        double total = segundosDesde(t0);
+        uint64_t amostras = totalAmostras(base);
+        if (!referencia) referencia = amostras;
+        char rotulo[32];
+        snprintf(rotulo, sizeof(rotulo), "%u thread%s", n, n > 1 ? "s" : "");
+        printf("%-22s %8.1f MB/s  leitura %.2f s, com relatórios %.2f s (%.1f M linhas, %llu amostras)\n", rotulo,
+               dados.size() / 1048576.0 / leitura, leitura, total, base.linhas / 1e6, (unsigned long long)amostras);
+        if (amostras != referencia) { fprintf(stderr, "resultado diferente com %u threads\n", n); return 1; }
+        if (n == maxThreads) break;
+    }
+    return 0;
+}
+
+// --------------------
+// Main
+// --------------------
+static const char *mapeia(const char *caminho, size_t &tam) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { perror(caminho); return nullptr; }
+    struct stat st;
+    fstat(fd, &st);
+    tam = st.st_size;
+    const char *p = tam ? (const char*)mmap(nullptr, tam, PROT_READ, MAP_PRIVATE, fd, 0) : "";
+    close(fd);
+    if (p == MAP_FAILED) { perror(caminho); return nullptr; }
+    if (tam) madvise((void*)p, tam, MADV_WILLNEED);
+    return p;
+}
+
+int main(int argc, char **argv) {
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    const char *resumoCsv = nullptr, *excursoes = nullptr, *colunas = nullptr;
+    int16_t minFixo, maxFixo;
+    bool temMin = false, temMax = false;
+    uint32_t lacuna = LACUNA_PADRAO;
+    std::vector<const char*> arquivos;
+
+    if (argc >= 3 && strcmp(argv[1], "gera") == 0) {
+        FILE *f = fopen(argv[2], "wb");
+        if (!f) { perror(argv[2]); return 2; }
+        uint64_t mb = argc > 3 ? strtoull(argv[3], nullptr, 10) : 100;
+        int estacoes = argc > 4 ? atoi(argv[4]) : 30;
+        geraLog([&](const char *p, size_t n) { fwrite(p, 1, n, f); }, mb << 20, estacoes, 1);
+        fclose(f);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        if (argc > 3) nThreads = std::max(1, atoi(argv[3]));
+        return bench(argc > 2 ? strtoull(argv[2], nullptr, 10) : 256, nThreads);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto prox = [&]() { if (i + 1 >= argc) { fprintf(stderr, "falta valor para %s\n", a.c_str()); exit(2); } return argv[++i]; };
+        if (a == "-j") nThreads = std::max(1, atoi(prox()));
+        else if (a == "--resumo") resumoCsv = prox();
+        else if (a == "--excursoes") excursoes = prox();
+        else if (a == "--colunas") colunas = prox();
+        else if (a == "--lacuna") lacuna = (uint32_t)atol(prox());
+        else if (a == "--min" || a == "--max") {
+            const char *v = prox();
+            if (!textoParaCenti(v, a == "--min" ? minFixo : maxFixo)) { fprintf(stderr, "temperatura inválida: %s\n", v); return 2; }
+            (a == "--min" ? temMin : temMax) = true;
+        }
+        else if (a[0] == '-') { fprintf(stderr, "opção desconhecida: %s (veja o cabeçalho de tools/analise_log.cpp)\n", a.c_str()); return 2; }
+        else arquivos.push_back(argv[i]);
+    }
+    if (arquivos.empty()) { fprintf(stderr, "uso: analise_log [opções] log.txt... (veja o cabeçalho de tools/analise_log.cpp)\n"); return 2; }
+
+    std::vector<Fonte> fontes;
+    for (const char *a : arquivos) {
+        size_t tam;
+        const char *p = mapeia(a, tam);
+        if (!p) return 2;
+        fontes.push_back({ p, tam });
+    }
+
+    auto t0 = Relogio::now();
+    Base base = analisa(fontes, nThreads);
+    double leitura = segundosDesde(t0);
+    std::vector<Resumo> resumos = relatorios(base, nThreads, lacuna, temMin ? &minFixo : nullptr, temMax ? &maxFixo : nullptr);
+    fprintf(stderr, "%zu arquivo(s), %.1f MB, %llu linhas (%llu ignoradas) em %.2f s: %.0f MB/s com %u threads\n",
+            fontes.size(), base.bytes / 1048576.0, (unsigned long long)base.linhas, (unsigned long long)base.ignoradas,
+            leitura, base.bytes / 1048576.0 / leitura, nThreads);
+
+    imprimeResumo(stdout, false, base, resumos);
+    bool ok = true;
+    if (resumoCsv) {
+        FILE *f = fopen(resumoCsv, "w");
+        if (!f) { perror(resumoCsv); return 2; }
+        imprimeResumo(f, true, base, resumos);
+        fclose(f);
+    }
+    if (excursoes) ok &= gravaExcursoes(excursoes, base, resumos);
+    if (colunas) ok &= gravaColunas(colunas, base, resumos);
+    for (size_t i = 0; i < fontes.size(); i++) if (fontes[i].tam) munmap((void*)fontes[i].dados, fontes[i].tam);
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,219 @@
+// --------------------
+// Benchmark de host: núcleo do receptor
+// --------------------
+// Roda o mesmo nucleo_receptor.h das placas com as políticas do PC
+// (politicas_host.h). Passos:
+//  1. pareia N estações;
+//  2. mede quadros/s e linhas/s no caminho do quadro (registro, alertas e
+//     formatação);
+//  3. avança o relógio simulado até todas ficarem faltantes, e confere que
+//     uma janela de heartbeat maior que 2^32 ms não dispara antes da hora;
+//  4. recarrega o registro do disco, como num reboot, e confere que nomes e
+//     IDs se mantêm, que quem não volta depois do reboot fica faltante pela
+//     política guardada e que um arquivo de outro MAX_SONDAS é descartado.
+// Sai com código 1 se alguma conferência falhar.
+//
+// Compilar e rodar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -Isrc tools/bench_receptor.cpp -o bench_receptor
+//   ./bench_receptor [estacoes] [quadros]
+//   ./bench_receptor 512 2000000 > /dev/null   (só as medições, no stderr)
+
+#define MAX_ESTACOES 512
+#define TEMP_MIN 0
+#define TEMP_MAX 10
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include "politicas_host.h"
+
+static double segundosDesde(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void macDe(uint8_t *mac, uint16_t i) {
+    const uint8_t base[6] = { 0x24, 0x6F, 0x28, 0x00, 0x00, 0x00 };
+    memcpy(mac, base, 6);
+    mac[4] = i >> 8;
+    mac[5] = i & 0xFF;
+}
+
+int main(int argc, char **argv) {
+    int nEstacoes = argc > 1 ? atoi(argv[1]) : 256;
+    long nQuadros = argc > 2 ? atol(argv[2]) : 1000000;
+    if (nEstacoes < 1 || nEstacoes > MAX_ESTACOES) { fprintf(stderr, "estações: 1 a %d\n", MAX_ESTACOES); return 2; }
+
+    char modelo[] = "/tmp/bench_receptorXXXXXX";
+    if (!mkdtemp(modelo)) { perror("mkdtemp"); return 2; }
+    ArmazenamentoHost::dir = modelo;
+    bool ok = true;
+
+    auto nucleo = std::make_unique<NucleoHost>();   // ~40 kB com 512 estações
+    nucleo->begin();
+
+    // 1. Pareamento
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nEstacoes; i++) {
+        uint8_t mac[6];
+        macDe(mac, i);
+        QuadroAnuncio a = { QUADRO_ANUNCIO, (uint8_t)(1 + i % MAX_SONDAS), {} };
+        snprintf(a.nome, sizeof(a.nome), "%s%d", i % 2 ? "Isopor" : "Garrafa", i / 2 + 1);
+        nucleo->processa(mac, (const uint8_t*)&a, sizeof(a));
+        nucleo->registro.persiste();   // como a tarefa de gravação das placas
+    }
+    double sPareamento = segundosDesde(t0);
+    for (int i = 0; i < nEstacoes; i++) {
+        uint8_t mac[6];
+        macDe(mac, i);
+        const RadioHost::Envio &e = RadioHost::enviados[i];
+        if (memcmp(e.mac, mac, 6) != 0 || e.quadro.id != i) { fprintf(stderr, "atribuição errada para a estação %d\n", i); ok = false; break; }
+    }
+    fprintf(stderr, "pareamento: %d estações em %.1f ms (grava o registro a cada uma)\n", nEstacoes, sPareamento * 1e3);
+
+    // 2. Caminho do quadro
+    std::mt19937 rng(1);
+    std::vector<int16_t> temp(nEstacoes, 500);
+    std::vector<uint16_t> seq(nEstacoes, 0);
+    ArmazenamentoHost::linhas.clear();
+    ArmazenamentoHost::saida = fopen("/dev/null", "w");
+    ArmazenamentoHost::gravadas = ArmazenamentoHost::bytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (long q = 0; q < nQuadros; q++) {
+        uint16_t i = rng() % nEstacoes;
+        uint8_t mac[6];
+        macDe(mac, i);
+        SensorData d = {};
+        d.tipo = QUADRO_DADOS;
+        d.id = i;
+        d.seq = ++seq[i];
+        d.heartbeat = HEARTBEAT;
+        d.intervalo_s = 60;
+        d.n_sondas = 1 + i % MAX_SONDAS;
+        d.resolucao = 12;
+        d.limites = assinaturaLimites(RadioHost::enviados[i].quadro.min_cc, RadioHost::enviados[i].quadro.max_cc);
+        temp[i] += (int16_t)(rng() % 61) - 30;
+        temp[i] = temp[i] < -500 ? -500 : (temp[i] > 1800 ? 1800 : temp[i]);
+        for (uint8_t s = 0; s < d.n_sondas; s++) d.temp_cc[s] = temp[i] - s * 20;
+        nucleo->processa(mac, (const uint8_t*)&d, (int)tamanhoQuadro(d.n_sondas));
+        if ((q & 1023) == 0) RelogioHost::avanca(1000);
+    }
+    double s = segundosDesde(t0);
+    fclose(ArmazenamentoHost::saida);
+    ArmazenamentoHost::saida = nullptr;
+    fprintf(stderr, "quadros: %ld em %.2f s = %.0f quadros/s, %.0f ns/quadro, %.1f M linhas/s (%.1f MB de log)\n",
+            nQuadros, s, nQuadros / s, s * 1e9 / nQuadros, ArmazenamentoHost::gravadas / s / 1e6, ArmazenamentoHost::bytes / 1048576.0);
+
+    // Exemplo do que as placas gravariam
+    ArmazenamentoHost::linhas.clear();
+    nucleo->amostraAmbiente(2345);
+    SensorData d = nucleo->dados[0];
+    uint8_t mac0[6];
+    macDe(mac0, 0);
+    d.temp_cc[0] = 1250;
+    nucleo->processaDados(mac0, d);
+    d.temp_cc[0] = 480;
+    nucleo->processaDados(mac0, d);
+    const char *msg;
+    if (nucleo->editaEstacao("0", nullptr, "Geladeira", "2.5", "8", msg) != 200) { fprintf(stderr, "edição recusada: %s\n", msg); ok = false; }
+    if (nucleo->editaEstacao("0", nullptr, nullptr, "9", "8", msg) != 400) { fprintf(stderr, "min > max aceito\n"); ok = false; }
+    if (nucleo->editaEstacao("0", "9", nullptr, "1", nullptr, msg) != 400) { fprintf(stderr, "sonda 9 aceita\n"); ok = false; }
+
+    // Limites por sonda: a 2ª sonda da estação 1 vira "Freezer" com faixa própria;
+    // a 1ª segue o padrão da estação
+    nucleo->editaEstacao("1", nullptr, nullptr, "0", "10", msg);
+    if (nucleo->editaEstacao("1", "2", "Freezer", "20", "30", msg) != 200) { fprintf(stderr, "edição da sonda recusada: %s\n", msg); ok = false; }
+    uint8_t mac1[6];
+    macDe(mac1, 1);
+    SensorData d1 = nucleo->dados[1];
+    d1.temp_cc[0] = d1.temp_cc[1] = 500;
+    d1.seq++;
+    size_t respostas = RadioHost::enviados.size();
+    nucleo->processaDados(mac1, d1);
+    // O quadro veio com a assinatura dos limites do pareamento: o RX responde com os novos
+    if (RadioHost::enviados.size() != respostas + 1 || RadioHost::enviados.back().quadro.min_cc[1] != 2000 ||
+        RadioHost::enviados.back().quadro.max_cc[0] != 1000) {
+        fprintf(stderr, "limites editados não foram ao TX\n");
+        ok = false;
+    } else {
+        const QuadroAtribuicao &q = RadioHost::enviados.back().quadro;
+        d1.limites = assinaturaLimites(q.min_cc, q.max_cc);
+    }
+    size_t antesSonda = ArmazenamentoHost::linhas.size();
+    d1.temp_cc[0] = d1.temp_cc[1] = 2500;
+    d1.seq++;
+    nucleo->processaDados(mac1, d1);
+    if (RadioHost::enviados.size() != respostas + 1) { fprintf(stderr, "resposta repetida com limites em dia\n"); ok = false; }
+    bool acimaPadrao = false, freezerOk = false;
+    for (size_t i = antesSonda; i < ArmazenamentoHost::linhas.size(); i++) {
+        const std::string &l = ArmazenamentoHost::linhas[i];
+        if (l.find("Est: Isopor1 |") != std::string::npos && l.find("acima de 10.00") != std::string::npos) acimaPadrao = true;
+        if (l.find("Est: Freezer |") != std::string::npos && l.find("ALERTA") == std::string::npos) freezerOk = true;
+    }
+    if (!acimaPadrao || !freezerOk) { fprintf(stderr, "limites por sonda ignorados\n"); ok = false; }
+
+    // 3. Faltantes: uma janela inteira de heartbeat sem quadros, uma linha por subcanal
+    RelogioHost::avanca((uint64_t)(HEARTBEAT + 1) * 60 * 1000 + TIMEOUT_MS);
+    size_t antes = ArmazenamentoHost::linhas.size();
+    nucleo->verificaSilencio();
+    size_t faltantes = ArmazenamentoHost::linhas.size() - antes, canais = 0;
+    for (int i = 0; i < nEstacoes; i++) canais += nCanais(nucleo->registro.copia(i));
+    bool freezerFaltante = false;
+    for (size_t i = antes; i < ArmazenamentoHost::linhas.size(); i++) freezerFaltante |= ArmazenamentoHost::linhas[i] == "Estacao faltante: Freezer";
+    if (faltantes != canais || !freezerFaltante) { fprintf(stderr, "faltantes: %zu linhas para %zu subcanais\n", faltantes, canais); ok = false; }
+    for (size_t i = 0; i < ArmazenamentoHost::linhas.size() && i < 5; i++) printf("%s\n", ArmazenamentoHost::linhas[i].c_str());
+    printf("... %zu linhas \"Estacao faltante\"\n", faltantes);
+
+    // Janela longa: HEARTBEAT=10 com intervalo de 5 dias (~50 dias de silêncio)
+    d = nucleo->dados[0];
+    d.heartbeat = 10;
+    d.intervalo_s = 5 * 86400;
+    nucleo->processaDados(mac0, d);
+    RelogioHost::avanca(49ULL * 86400 * 1000);
+    antes = ArmazenamentoHost::linhas.size();
+    nucleo->verificaSilencio();
+    if (ArmazenamentoHost::linhas.size() != antes) { fprintf(stderr, "janela de 50 dias disparou em 49\n"); ok = false; }
+    RelogioHost::avanca(2ULL * 86400 * 1000);
+    nucleo->verificaSilencio();
+    if (ArmazenamentoHost::linhas.size() != antes + 1) { fprintf(stderr, "janela de 50 dias não disparou em 51\n"); ok = false; }
+
+    std::string json;
+    nucleo->estacoesJson(json, 0);
+    printf("/estacoes: %.200s...\n", json.c_str());
+
+    // 4. Reboot: o registro volta do disco com os mesmos IDs e a edição
+    nucleo->registro.persiste();
+    auto depois = std::make_unique<NucleoHost>();
+    uint16_t carregadas = depois->begin();
+    if (carregadas != nEstacoes || strcmp(depois->registro.copia(0).nome, "Geladeira") != 0 ||
+        depois->registro.copia(0).minCC != 250 || depois->registro.copia(1).sondas[1].minCC != 2000 ||
+        depois->registro.localiza(nEstacoes - 1, mac0) != 0) {
+        fprintf(stderr, "registro recarregado diferente (%u estações)\n", carregadas);
+        ok = false;
+    }
+    fprintf(stderr, "reboot: %u estações recarregadas de %s%s\n", carregadas, modelo, REGISTRO_PATH);
+
+    // Nenhum quadro depois do reboot: a janela de 60 s x HEARTBEAT fecha para
+    // todas menos a estação 0, que guardou o intervalo de 5 dias
+    RelogioHost::avanca((uint64_t)(HEARTBEAT + 1) * 60 * 1000 + TIMEOUT_MS);
+    antes = ArmazenamentoHost::linhas.size();
+    depois->verificaSilencio();
+    size_t semQuadro = canais - nCanais(depois->registro.copia(0));
+    if (ArmazenamentoHost::linhas.size() - antes != semQuadro) {
+        fprintf(stderr, "depois do reboot: %zu faltantes para %zu subcanais\n", ArmazenamentoHost::linhas.size() - antes, semQuadro);
+        ok = false;
+    }
+
+    // Arquivo de um build com outro MAX_SONDAS: descartado, não lido torto
+    CabecalhoRegistro outro = { REGISTRO_MAGIC, MAX_SONDAS + 1, sizeof(Estacao) };
+    ArmazenamentoHost::escreve(REGISTRO_PATH, 0, &outro, sizeof(outro));
+    if (std::make_unique<NucleoHost>()->begin() != 0) { fprintf(stderr, "registro de outro MAX_SONDAS aceito\n"); ok = false; }
+
+    unlink((std::string(modelo) + REGISTRO_PATH).c_str());
+    rmdir(modelo);
+    fprintf(stderr, "%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// --------------------
+// Benchmark de host: caminho float x ponto fixo da temperatura
+// --------------------
+// Compara o caminho antigo (getTempC -> round(temp * 100.0) / 100.0 -> "%.2f")
+// com o novo (raw 1/128 °C -> centésimos int16 -> formatCenti), confere que o
+// texto gerado é idêntico para toda a faixa do DS18B20 e mede o custo de cada um.
+//
+// No host o float roda em FPU, então a vantagem medida aqui é um limite inferior:
+// no ESP8266 (sem FPU) cada operação float/double vira chamada de soft-float.
+//
+// Compilar e rodar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -Isrc tools/bench_temperatura.cpp -o bench_temperatura
+//   ./bench_temperatura
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define TEMP_MIN 0
+#define TEMP_MAX 10
+#include "temperatura.h"
+
+static const int RAW_MIN = -55 * 128;   // faixa do DS18B20: -55 a 125 °C
+static const int RAW_MAX = 125 * 128;
+
+// Caminho antigo, como em DallasTemperature::rawToCelsius + esp8266_tx.h
+static int formatFloat(char *buf, size_t len, int raw) {
+    float temp = (raw <= RAW_DESCONECTADO) ? -127.0f : (float)raw * 0.0078125f;
+    temp = round(temp * 100.0) / 100.0;
+    return snprintf(buf, len, "%.2f", temp);
+}
+
+static int formatFixo(char *buf, size_t len, int raw) {
+    return formatCenti(buf, len, rawParaCenti(raw));
+}
+
+template <typename F>
+static double medeNs(F f, int repeticoes, unsigned &soma) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeticoes; r++)
+        for (int raw = RAW_MIN; raw <= RAW_MAX; raw++) soma += f(raw);
+    auto t1 = std::chrono::steady_clock::now();
+    double total = (double)repeticoes * (RAW_MAX - RAW_MIN + 1);
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / total;
+}
+
+int main() {
+    // 1) Equivalência do texto (passo 1/128 cobre também resoluções de 9 a 12 bits)
+    int divergencias = 0;
+    char a[16], b[16];
+    for (int raw = RAW_MIN; raw <= RAW_MAX; raw++) {
+        formatFloat(a, sizeof(a), raw);
+        formatFixo(b, sizeof(b), raw);
+        if (strcmp(a, b) != 0) {
+            if (divergencias++ < 10) printf("raw=%d float=%s fixo=%s\n", raw, a, b);
+        }
+    }
+    printf("equivalencia: %d divergencias em %d leituras\n", divergencias, RAW_MAX - RAW_MIN + 1);
+
+    // 2) Custo só da conversão (o que roda no TX e nos alertas do RX)
+    const int REP = 200;
+    unsigned soma = 0;
+    double nsFloat = medeNs([](int raw) {
+        volatile float t = (float)raw * 0.0078125f;
+        float r = round(t * 100.0) / 100.0;
+        return (unsigned)(r > TEMP_MAX) + (unsigned)(r < TEMP_MIN);
+    }, REP, soma);
+    double nsFixo = medeNs([](int raw) {
+        volatile int v = raw;
+        int16_t c = rawParaCenti(v);
+        return (unsigned)(c > TEMP_MAX_CC) + (unsigned)(c < TEMP_MIN_CC);
+    }, REP, soma);
+    printf("conversao+limites: float %.2f ns  fixo %.2f ns  (%.1fx)\n", nsFloat, nsFixo, nsFloat / nsFixo);
+
+    // 3) Custo com formatação do texto do log
+    nsFloat = medeNs([&](int raw) { return (unsigned)formatFloat(a, sizeof(a), raw); }, 10, soma);
+    nsFixo = medeNs([&](int raw) { return (unsigned)formatFixo(b, sizeof(b), raw); }, 10, soma);
+    printf("conversao+texto:   float %.2f ns  fixo %.2f ns  (%.1fx)\n", nsFloat, nsFixo, nsFloat / nsFixo);
+
+    printf("(checksum %u)\n", soma);
+    return divergencias ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// --------------------
+// Coletor UDP de teste para o envio de log (enviador.h)
+// --------------------
+// Modo servidor: recebe lotes, grava os bytes dos registros em
+// <dir>/<origem>_<sessao>.txt (cópia byte a byte do log do receptor, fins de
+// linha incluídos) e confirma até onde já tem (lotes repetidos ou fora de
+// ordem são só re-confirmados). O arquivo só cresce: a posição esperada é
+// <dir>/<chave>.base (posição do primeiro byte) mais o tamanho do .txt, então
+// um coletor reiniciado continua a sessão de onde parou em vez de zerá-la.
+// Modo envia: simula o receptor lendo um log.txt local com o mesmo codec e o
+// mesmo protocolo de ACK/retentativa, com perda opcional de pacotes.
+// Os dois modos mostram registros/s e bytes por registro no fio.
+//
+// Compilar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -Isrc tools/coletor_mock.cpp -o coletor_mock
+// Uso:
+//   ./coletor_mock servidor 5005 coletado/
+//   ./coletor_mock envia 127.0.0.1 5005 log.txt [perda_%]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "codec_lote.h"
+
+using Relogio = std::chrono::steady_clock;
+
+static double segundosDesde(Relogio::time_point t0) {
+    return std::chrono::duration<double>(Relogio::now() - t0).count();
+}
+
+struct Fluxo {
+    uint32_t esperado = 0;
+    FILE *arquivo = nullptr;
+};
+
+// Abre (ou retoma) o arquivo da sessão. Sessão nunca vista começa onde o
+// receptor começou, que pode não ser 0 depois de rotação.
+static bool abreFluxo(const std::string &caminho, uint32_t inicio, Fluxo &f) {
+    std::string base = caminho + ".base";
+    FILE *b = fopen(base.c_str(), "r");
+    unsigned long primeiro = 0;
+    bool temBase = b && fscanf(b, "%lu", &primeiro) == 1;
+    if (b) fclose(b);
+    f.arquivo = fopen((caminho + ".txt").c_str(), "ab");
+    if (!f.arquivo) return false;
+    fseek(f.arquivo, 0, SEEK_END);
+    long tam = ftell(f.arquivo);
+    if (!temBase) {
+        primeiro = tam > 0 ? 0 : inicio;   // .txt sem .base: gravado desde o byte 0
+        b = fopen(base.c_str(), "w");
+        if (b) { fprintf(b, "%lu\n", primeiro); fclose(b); }
+    }
+    f.esperado = (uint32_t)(primeiro + tam);
+    if (tam > 0) printf("%s: retomando em %lu\n", caminho.c_str(), (unsigned long)f.esperado);
+    return true;
+}
+
+static int servidor(int porta, const std::string &dir) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(porta);
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) != 0) { perror("bind"); return 1; }
+    timeval tv = {1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    printf("coletor ouvindo em UDP %d, gravando em %s\n", porta, dir.c_str());
+
+    std::map<std::string, Fluxo> fluxos;
+    uint64_t registros = 0, bytesFio = 0, bytesTexto = 0, lotes = 0, repetidos = 0;
+    auto t0 = Relogio::now();
+    auto ultimoRelatorio = t0;
+    uint8_t buf[2048];
+
+    for (;;) {
+        sockaddr_in de = {};
+        socklen_t deLen = sizeof(de);
+        ssize_t n = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr *)&de, &deLen);
+        if (n > 0) {
+            CabecalhoLote cab;
+            std::string dados;
+            uint32_t nRegistros = 0;
+            if (decodificaLote(buf, n, cab, [&](const char *l, size_t len) { dados.append(l, len); nRegistros++; }) &&
+                dados.size() == cab.fim - cab.inicio) {
+                char chave[64];
+                snprintf(chave, sizeof(chave), "%s_%08x", cab.origem, cab.sessao);
+                for (char *c = chave; *c; c++) if (*c == ':') *c = '-';
+                Fluxo &f = fluxos[chave];
+                if (!f.arquivo && !abreFluxo(dir + "/" + chave, cab.inicio, f)) { perror(chave); continue; }
+                // Fora da posição esperada (repetido, lacuna ou coletor reiniciado):
+                // nada é gravado e o ACK diz ao receptor de onde continuar
+                if (cab.inicio == f.esperado) {
+                    bytesTexto += fwrite(dados.data(), 1, dados.size(), f.arquivo);
+                    fflush(f.arquivo);
+                    f.esperado = cab.fim;
+                    registros += nRegistros;
+                    bytesFio += n;
+                    lotes++;
+                } else {
+                    repetidos++;
+                }
+                uint8_t ack[ACK_TAM];
+                montaAck(ack, cab.sessao, f.esperado);
+                sendto(sock, ack, sizeof(ack), 0, (sockaddr *)&de, deLen);
+            }
+        }
+        if (std::chrono::duration<double>(Relogio::now() - ultimoRelatorio).count() >= 5 && registros) {
+            ultimoRelatorio = Relogio::now();
+            printf("%llu registros em %llu lotes (%llu repetidos) | %.0f reg/s | %.1f B/reg no fio, %.1f B/reg em texto (%.1fx)\n",
+                   (unsigned long long)registros, (unsigned long long)lotes, (unsigned long long)repetidos,
+                   registros / segundosDesde(t0), (double)bytesFio / registros, (double)bytesTexto / registros,
+                   (double)bytesTexto / bytesFio);
+        }
+    }
+}
+
+static int envia(const char *host, int porta, const char *caminho, int perda) {
+    FILE *f = fopen(caminho, "rb");
+    if (!f) { perror(caminho); return 1; }
+    std::vector<uint8_t> log;
+    uint8_t tmp[65536];
+    size_t n;
+    while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0) log.insert(log.end(), tmp, tmp + n);
+    fclose(f);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in dest = {};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(porta);
+    inet_pton(AF_INET, host, &dest.sin_addr);
+    timeval tv = {0, 200000};   // ACK em 200 ms no host
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    uint32_t sessao = (uint32_t)time(nullptr);
+    uint32_t confirmado = 0;
+    uint64_t registros = 0, bytesFio = 0, retentativas = 0;
+    CodificadorLote cod;
+    uint8_t lote[LOTE_MAX];
+    srand(sessao);
+    auto t0 = Relogio::now();
+
+    while (confirmado < log.size()) {
+        // Mesma montagem do enviador: janela de 2 KB a partir do confirmado, só linhas completas
+        cod.inicia(lote, sizeof(lote), "host-mock", sessao, confirmado);
+        size_t ini = confirmado, lim = std::min(log.size(), (size_t)confirmado + 2048);
+        while (ini < lim) {
+            const uint8_t *nl = (const uint8_t *)memchr(&log[ini], '\n', lim - ini);
+            size_t fim;
+            if (nl) fim = nl - log.data() + 1;
+            else if (ini == confirmado && lim - ini == 2048) fim = lim;   // linha maior que a janela
+            else break;
+            if (ini == confirmado && fim - ini > LOTE_PEDACO_MAX) fim = ini + LOTE_PEDACO_MAX;   // linha longa: em pedaços
+            if (!cod.adiciona((const char *)&log[ini], fim - ini)) break;
+            ini = fim;
+        }
+        if (cod.totalRegistros() == 0) break;   // resto sem '\n' final
+        size_t len = cod.finaliza();
+
+        if (rand() % 100 >= perda) sendto(sock, lote, len, 0, (sockaddr *)&dest, sizeof(dest));
+        bytesFio += len;
+        uint8_t ack[ACK_TAM];
+        ssize_t r = recv(sock, ack, sizeof(ack), 0);
+        uint32_t s, conf;
+        if (r > 0 && rand() % 100 >= perda && leAck(ack, r, s, conf) && s == sessao) {
+            if (conf == cod.posicaoFim()) registros += cod.totalRegistros();
+            confirmado = conf;
+        } else {
+            retentativas++;
+        }
+    }
+    double dt = segundosDesde(t0);
+    printf("%llu registros, %zu bytes de log em %.2f s | %.0f reg/s | %.1f B/reg no fio (%.1f B/reg em texto) | %llu retentativas\n",
+           (unsigned long long)registros, log.size(), dt, registros / dt,
+           registros ? (double)bytesFio / registros : 0.0, registros ? (double)log.size() / registros : 0.0,
+           (unsigned long long)retentativas);
+    return confirmado == log.size() ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && std::string(argv[1]) == "servidor")
+        return servidor(atoi(argv[2]), argc >= 4 ? argv[3] : ".");
+    if (argc >= 5 && std::string(argv[1]) == "envia")
+        return envia(argv[2], atoi(argv[3]), argv[4], argc >= 6 ? atoi(argv[5]) : 0);
+    fprintf(stderr, "uso: %s servidor <porta> [dir] | envia <host> <porta> <log.txt> [perda_%%]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,329 @@
+// --------------------
+// Modelo de energia e autonomia dos transmissores
+// --------------------
+// Junta o perfil de fases medido pelos transmissores (rota /energia do
+// receptor, unidades de 100 µs) com um modelo de corrente por placa e estima
+// mAh por ciclo, mAh por dia e autonomia da bateria. As políticas (intervalo,
+// banda morta/heartbeat, lote, resolução de 9 a 12 bits) são comparadas por
+// simulação sobre uma série de temperatura: sintética ou tirada de um log.txt.
+//
+// Compilar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -Isrc tools/energia.cpp -o energia
+// Exemplos:
+//   ./energia --placa esp8266 --comparar
+//   ./energia --csv energia.csv --placa esp32 --bateria 2600
+//   ./energia --log log.txt --estacao Garrafa1 --comparar --limite-mah-dia 20
+//
+// Com --limite-mah-dia o programa sai com código 1 se alguma linha passar do
+// limite, para pegar regressões de energia antes de ir a campo.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// A decisão de envio é a do firmware (politica_envio.h); banda morta e
+// heartbeat viram variáveis para comparar políticas na mesma execução
+static int16_t bandaSimuladaCC = 25;
+static int heartbeatSimulado = 10;
+#define BANDA_MORTA_CC bandaSimuladaCC
+#define HEARTBEAT heartbeatSimulado
+
+#include "perfil_energia.h"
+#include "politica_envio.h"
+
+static const char *NOMES_FASES[N_FASES] = { "boot", "conversao", "radio", "envio", "ack" };
+
+// Correntes médias por fase (mA) e duração típica das fases (ms) a 12 bits.
+// Valores de datasheet/bancada; ajuste com --corrente fase=mA se medir a placa.
+struct Placa {
+    const char *nome;
+    double correnteMa[N_FASES];
+    double sonoMa;
+    double fasesMs[N_FASES];
+};
+
+static Placa PLACAS[] = {
+    // ESP32: boot sem rádio, conversão em delay(), TX ~180 mA, espera de ACK em RX
+    { "esp32",   { 40, 30, 120, 180, 100 }, 0.010, { 250, 760, 60, 1.0, 3.0 } },
+    // ESP8266: o RF calibra no boot e fica ligado até o forceSleep
+    { "esp8266", { 70, 70,  80, 170,  70 }, 0.020, { 120, 760, 40, 1.0, 3.0 } },
+};
+
+struct Politica {
+    std::string nome;
+    double intervaloS;
+    double bandaC;       // 0 = transmite todo despertar
+    int heartbeat;
+    int lote;            // leituras por quadro (>1 = acumula e envia a cada lote)
+    int resolucao;
+};
+
+struct Resultado {
+    double enviosDia;
+    double mAhCiclo;
+    double mAhDia;
+    double autonomiaDias;
+};
+
+static double conversaoMs(int bits) { return 93.75 * (1 << (bits - 9)); }
+static double passoC(int bits) { return 0.5 / (1 << (bits - 9)); }
+
+// --------------------
+// Séries de temperatura
+// --------------------
+struct Amostra { double t; double temp; };
+
+// Geladeira sintética: ciclo do compressor, aberturas de porta e ruído
+static std::vector<Amostra> serieSintetica(double dias) {
+    std::vector<Amostra> s;
+    std::mt19937 rng(42);
+    std::normal_distribution<double> ruido(0, 0.03);
+    std::exponential_distribution<double> entrePortas(1.0 / 5400);   // uma abertura a cada 1,5 h
+    double proximaPorta = entrePortas(rng), porta = 0;
+    for (double t = 0; t < dias * 86400; t += 10) {
+        if (t >= proximaPorta) { porta = 3.0; proximaPorta = t + entrePortas(rng); }
+        porta *= std::exp(-10.0 / 600);
+        double temp = 4.0 + 0.8 * std::sin(2 * M_PI * t / 2400) + porta + ruido(rng);
+        s.push_back({ t, temp });
+    }
+    return s;
+}
+
+// Dias desde 01/01/1970 no calendário gregoriano (algoritmo de H. Hinnant),
+// o mesmo do tools/analise_log.cpp
+static int64_t diasDesde1970(int a, unsigned m, unsigned d) {
+    a -= m <= 2;
+    const int era = (a >= 0 ? a : a - 399) / 400;
+    const unsigned aDaEra = (unsigned)(a - era * 400);
+    const unsigned diaDoAno = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned diaDaEra = aDaEra * 365 + aDaEra / 4 - aDaEra / 100 + diaDoAno;
+    return era * 146097LL + (int64_t)diaDaEra - 719468;
+}
+
+// Linhas "dd/mm/aaaa hh:mm:ss - Est: NOME | Temp: X °C" da estação escolhida
+static std::vector<Amostra> serieDoLog(const char *caminho, const char *estacao) {
+    std::vector<Amostra> s;
+    FILE *f = fopen(caminho, "r");
+    if (!f) { perror(caminho); exit(2); }
+    char linha[512], chave[64];
+    snprintf(chave, sizeof(chave), " - Est: %s | Temp: ", estacao);
+    double t0 = -1;
+    while (fgets(linha, sizeof(linha), f)) {
+        const char *p = strstr(linha, chave);
+        if (!p) continue;
+        int d, mo, a, h, mi, se;
+        if (sscanf(linha, "%d/%d/%d %d:%d:%d", &d, &mo, &a, &h, &mi, &se) != 6) continue;
+        if (d < 1 || d > 31 || mo < 1 || mo > 12) continue;   // RTC sem bateria grava lixo
+        double t = ((diasDesde1970(a, mo, d) * 24.0 + h) * 60 + mi) * 60 + se;
+        if (t0 < 0) t0 = t;
+        s.push_back({ t - t0, atof(p + strlen(chave)) });
+    }
+    fclose(f);
+    if (s.size() < 2) { fprintf(stderr, "poucas amostras de %s em %s\n", estacao, caminho); exit(2); }
+    return s;
+}
+
+// --------------------
+// Simulação
+// --------------------
+// Cada despertar passa pelo deveEnviar/finalizaDespertar do transmissor, com a
+// leitura arredondada na resolução da política e convertida como no DS18B20
+static Resultado simula(const Placa &placa, const double fasesMs[N_FASES], int resolucaoMedida,
+                        const Politica &pol, const std::vector<Amostra> &serie,
+                        double tempMin, double tempMax, double bateriaMah) {
+    double fases[N_FASES];
+    memcpy(fases, fasesMs, sizeof(fases));
+    fases[FASE_CONVERSAO] += conversaoMs(pol.resolucao) - conversaoMs(resolucaoMedida);
+
+    double cargaDespertar = (fases[FASE_BOOT] * placa.correnteMa[FASE_BOOT] +
+                             fases[FASE_CONVERSAO] * placa.correnteMa[FASE_CONVERSAO]) / 3.6e6;
+    double cargaRadio = 0;
+    for (int f = FASE_RADIO; f < N_FASES; f++) cargaRadio += fases[f] * placa.correnteMa[f] / 3.6e6;
+    // O quadro cresce 2 bytes por leitura acumulada: a fase de envio escala com o lote
+    double cargaRadioLote = cargaRadio + (pol.lote - 1) * fases[FASE_ENVIO] * 0.05 * placa.correnteMa[FASE_ENVIO] / 3.6e6;
+    double ativoMs = fases[FASE_BOOT] + fases[FASE_CONVERSAO];
+
+    bandaSimuladaCC = centiDeGraus(pol.bandaC);   // banda 0: todo despertar transmite
+    heartbeatSimulado = pol.heartbeat;
+    TxRtcState st;
+    memset(&st, 0, sizeof(st));
+    iniciaDespertar(st);
+    st.nSondas = 1;
+    st.minCC[0] = centiDeGraus(tempMin);
+    st.maxCC[0] = centiDeGraus(tempMax);
+
+    double passo = passoC(pol.resolucao);
+    double duracao = serie.back().t - serie.front().t;
+    size_t j = 0;
+    int acumuladas = 0;
+    long despertares = 0, envios = 0;
+    double carga = 0;
+
+    for (double t = serie.front().t; t <= serie.back().t; t += pol.intervaloS) {
+        while (j + 1 < serie.size() && serie[j + 1].t <= t) j++;
+        // passo da resolução em 1/128 °C, como o valor raw da DallasTemperature
+        int16_t temp = rawParaCenti((int32_t)std::lround(std::round(serie[j].temp / passo) * passo * 128));
+        if (despertares++) iniciaDespertar(st);
+        carga += cargaDespertar;
+
+        bool envia;
+        uint8_t motivo;
+        if (pol.lote > 1) {
+            // lote não existe no firmware: acumula e só antecipa no cruzamento de limite
+            envia = ++acumuladas >= pol.lote || (deveEnviar(st, &temp, 1, motivo) && motivo == ENVIO_LIMITE);
+        } else {
+            envia = deveEnviar(st, &temp, 1, motivo);
+        }
+        finalizaDespertar(st, &temp, 1, envia);
+        if (envia) {
+            carga += pol.lote > 1 ? cargaRadioLote : cargaRadio;
+            acumuladas = 0;
+            envios++;
+        }
+        carga += placa.sonoMa * (pol.intervaloS * 1000 - ativoMs) / 3.6e6;
+    }
+
+    double dias = duracao / 86400;
+    Resultado r;
+    r.enviosDia = envios / dias;
+    r.mAhCiclo = carga / despertares;
+    r.mAhDia = carga / dias;
+    r.autonomiaDias = bateriaMah / r.mAhDia;
+    return r;
+}
+
+// --------------------
+// CSV da rota /energia
+// --------------------
+struct Estacao {
+    std::string nome;
+    int resolucao;
+    double intervaloS;
+    int heartbeat;
+    double fasesMs[N_FASES];
+};
+
+static std::vector<Estacao> leCsv(const char *caminho) {
+    std::vector<Estacao> v;
+    FILE *f = fopen(caminho, "r");
+    if (!f) { perror(caminho); exit(2); }
+    char linha[256];
+    fgets(linha, sizeof(linha), f);   // cabeçalho
+    while (fgets(linha, sizeof(linha), f)) {
+        char nome[32];
+        unsigned seq, res, intervalo, hb, fa[N_FASES];
+        if (sscanf(linha, "%31[^,],%u,%u,%u,%u,%u,%u,%u,%u,%u", nome, &seq, &res, &intervalo, &hb,
+                   &fa[0], &fa[1], &fa[2], &fa[3], &fa[4]) != 10) continue;
+        Estacao e;
+        e.nome = nome;
+        e.resolucao = res ? res : 12;
+        e.intervaloS = intervalo;
+        e.heartbeat = hb ? hb : 1;
+        for (int i = 0; i < N_FASES; i++) e.fasesMs[i] = fa[i] / 10.0;
+        v.push_back(e);
+    }
+    fclose(f);
+    return v;
+}
+
+static void imprimeCabecalho() {
+    printf("%-28s %10s %12s %10s %12s\n", "politica", "envios/dia", "uAh/ciclo", "mAh/dia", "autonomia");
+}
+
+static bool imprime(const std::string &nome, const Resultado &r, double limite) {
+    printf("%-28s %10.0f %12.2f %10.2f %9.0f d%s\n", nome.c_str(), r.enviosDia, r.mAhCiclo * 1000, r.mAhDia,
+           r.autonomiaDias, (limite > 0 && r.mAhDia > limite) ? "  << acima do limite" : "");
+    return limite > 0 && r.mAhDia > limite;
+}
+
+int main(int argc, char **argv) {
+    Placa *placa = &PLACAS[0];
+    const char *csv = nullptr, *log = nullptr, *estacao = "Garrafa1";
+    double bateria = 2000, limite = 0, tempMin = 0, tempMax = 10, dias = 7;
+    bool comparar = false;
+    Politica base = { "atual", 60, 0.25, 10, 1, 12 };
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto prox = [&]() { if (i + 1 >= argc) { fprintf(stderr, "falta valor para %s\n", a.c_str()); exit(2); } return argv[++i]; };
+        if (a == "--placa") {
+            std::string p = prox();
+            placa = nullptr;
+            for (auto &pl : PLACAS) if (p == pl.nome) placa = &pl;
+            if (!placa) { fprintf(stderr, "placa desconhecida: %s\n", p.c_str()); return 2; }
+        }
+        else if (a == "--csv") csv = prox();
+        else if (a == "--log") log = prox();
+        else if (a == "--estacao") estacao = prox();
+        else if (a == "--bateria") bateria = atof(prox());
+        else if (a == "--dias") dias = atof(prox());
+        else if (a == "--intervalo") base.intervaloS = atof(prox());
+        else if (a == "--banda") base.bandaC = atof(prox());
+        else if (a == "--heartbeat") base.heartbeat = atoi(prox());
+        else if (a == "--lote") base.lote = atoi(prox());
+        else if (a == "--resolucao") base.resolucao = atoi(prox());
+        else if (a == "--temp-min") tempMin = atof(prox());
+        else if (a == "--temp-max") tempMax = atof(prox());
+        else if (a == "--limite-mah-dia") limite = atof(prox());
+        else if (a == "--comparar") comparar = true;
+        else if (a == "--corrente") {
+            // fase=mA, ex.: --corrente radio=95 (sono=mA para o deep sleep)
+            std::string v = prox();
+            size_t eq = v.find('=');
+            std::string fase = v.substr(0, eq);
+            double ma = atof(v.c_str() + eq + 1);
+            if (fase == "sono") placa->sonoMa = ma;
+            for (int f = 0; f < N_FASES; f++) if (fase == NOMES_FASES[f]) placa->correnteMa[f] = ma;
+        }
+        else { fprintf(stderr, "opção desconhecida: %s (veja o cabeçalho de tools/energia.cpp)\n", a.c_str()); return 2; }
+    }
+    if (base.resolucao < 9 || base.resolucao > 12) { fprintf(stderr, "resolução deve ser de 9 a 12 bits\n"); return 2; }
+
+    std::vector<Amostra> serie = log ? serieDoLog(log, estacao) : serieSintetica(dias);
+    printf("placa %s, bateria %.0f mAh, série %s (%.1f dias)\n", placa->nome, bateria,
+           log ? log : "sintética", (serie.back().t - serie.front().t) / 86400);
+
+    bool excedeu = false;
+
+    // Perfil medido em campo: uma linha por estação com a política configurada nela
+    if (csv) {
+        printf("\n-- estações (fases medidas) --\n");
+        imprimeCabecalho();
+        for (auto &e : leCsv(csv)) {
+            Politica p = base;
+            p.intervaloS = e.intervaloS;
+            p.heartbeat = e.heartbeat;
+            p.resolucao = e.resolucao;
+            char fases[96];
+            snprintf(fases, sizeof(fases), " [%.0f/%.0f/%.0f/%.1f/%.1f ms]", e.fasesMs[0], e.fasesMs[1], e.fasesMs[2], e.fasesMs[3], e.fasesMs[4]);
+            excedeu |= imprime(e.nome + fases, simula(*placa, e.fasesMs, e.resolucao, p, serie, tempMin, tempMax, bateria), limite);
+        }
+    }
+
+    printf("\n-- política base (fases típicas da placa) --\n");
+    imprimeCabecalho();
+    excedeu |= imprime("atual", simula(*placa, placa->fasesMs, 12, base, serie, tempMin, tempMax, bateria), limite);
+
+    if (comparar) {
+        printf("\n-- comparação --\n");
+        imprimeCabecalho();
+        std::vector<Politica> pols;
+        for (double iv : { 30.0, 60.0, 300.0 }) {
+            char nome[64];
+            snprintf(nome, sizeof(nome), "sempre %gs 12b", iv);
+            pols.push_back({ nome, iv, 0, 1, 1, 12 });
+            for (int res = 9; res <= 12; res++) {
+                snprintf(nome, sizeof(nome), "banda %.2f hb%d %gs %db", base.bandaC, base.heartbeat, iv, res);
+                pols.push_back({ nome, iv, base.bandaC, base.heartbeat, 1, res });
+            }
+            snprintf(nome, sizeof(nome), "lote 5 %gs 12b", iv);
+            pols.push_back({ nome, iv, 0, 1, 5, 12 });
+        }
+        for (auto &p : pols) excedeu |= imprime(p.nome, simula(*placa, placa->fasesMs, 12, p, serie, tempMin, tempMax, bateria), limite);
+    }
+    return excedeu ? 1 : 0;
+}
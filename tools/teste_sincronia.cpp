@@ -0,0 +1,95 @@
+// --------------------
+// Teste de host: sincronia incremental do /log
+// --------------------
+// Confere as decisões de sincronia_log.h que o handleLog das placas usa, sem
+// servidor web: cursor (leCursor/formataCursor), Range (leRange) e a resposta
+// escolhida por resolvePedidoLog para since, Range e If-None-Match, inclusive
+// depois de rotação e de log zerado.
+// Sai com código 1 se alguma conferência falhar.
+//
+// Compilar e rodar (na raiz do repositório):
+//   g++ -O2 -std=gnu++17 -Isrc tools/teste_sincronia.cpp -o teste_sincronia
+//   ./teste_sincronia
+
+#include "sincronia_log.h"
+
+static bool ok = true;
+
+static void confere(bool cond, const char *oque) {
+    if (!cond) { fprintf(stderr, "falhou: %s\n", oque); ok = false; }
+}
+
+static void confereResposta(const char *since, const char *range, const char *inm,
+                            uint32_t inicio, uint32_t fim,
+                            int codigo, uint32_t de, uint32_t ate, bool reinicio, uint32_t lacuna) {
+    RespostaLog r = resolvePedidoLog(since, range, inm, 0xabcu, inicio, fim);
+    if (r.codigo == codigo && r.de == de && r.ate == ate && r.reinicio == reinicio && r.lacuna == lacuna) return;
+    fprintf(stderr, "falhou: since=%s range=%s inm=%s [%lu, %lu) -> %d [%lu, %lu) reinicio=%d lacuna=%lu,"
+                    " esperado %d [%lu, %lu) reinicio=%d lacuna=%lu\n",
+            since ? since : "-", range ? range : "-", inm ? inm : "-",
+            (unsigned long)inicio, (unsigned long)fim,
+            r.codigo, (unsigned long)r.de, (unsigned long)r.ate, r.reinicio, (unsigned long)r.lacuna,
+            codigo, (unsigned long)de, (unsigned long)ate, reinicio, (unsigned long)lacuna);
+    ok = false;
+}
+
+int main() {
+    // Cursor: ida e volta, inclusive nos limites de 32 bits e no tamanho do buffer
+    char cursor[LOG_CURSOR_MAX], etag[LOG_CURSOR_MAX + 2];
+    uint32_t sessao = 0, pos = 0;
+    formataCursor(cursor, sizeof(cursor), 0xffffffffu, 4294967295u);
+    confere(strcmp(cursor, "ffffffff-4294967295") == 0, "cursor no limite de 32 bits");
+    confere(leCursor(cursor, sessao, pos) && sessao == 0xffffffffu && pos == 4294967295u, "cursor lido de volta");
+    formataEtag(etag, sizeof(etag), 0xffffffffu, 4294967295u);
+    confere(strcmp(etag, "\"ffffffff-4294967295\"") == 0, "ETag no limite de 32 bits");
+    confere(!leCursor("", sessao, pos), "cursor vazio");
+    confere(!leCursor("abc", sessao, pos), "cursor sem posição");
+    confere(!leCursor("abc-", sessao, pos), "cursor com posição vazia");
+    confere(!leCursor("abc-12x", sessao, pos), "cursor com lixo no fim");
+    confere(!leCursor("-12", sessao, pos), "cursor sem sessão");
+
+    // Range: formas aceitas e recusadas, com fim = 500
+    uint32_t de = 0, ate = 0;
+    confere(leRange("bytes=200-", 500, de, ate) && de == 200 && ate == 500, "bytes=a-");
+    confere(leRange("bytes=200-299", 500, de, ate) && de == 200 && ate == 300, "bytes=a-b");
+    confere(leRange("bytes=200-9999", 500, de, ate) && de == 200 && ate == 500, "bytes=a-b além do fim");
+    confere(leRange("bytes=-50", 500, de, ate) && de == 450 && ate == 500, "bytes=-n");
+    confere(leRange("bytes=-1000", 500, de, ate) && de == 0 && ate == 500, "bytes=-n maior que o log");
+    confere(!leRange("bytes=1-2,5-6", 500, de, ate), "faixas múltiplas");
+    confere(!leRange("bytes=-0", 500, de, ate), "sufixo vazio");
+    confere(!leRange("bytes=9-3", 500, de, ate), "faixa invertida");
+    confere(!leRange("itens=0-10", 500, de, ate), "unidade desconhecida");
+    confere(!leRange("bytes=x-", 500, de, ate), "início não numérico");
+
+    // Pedidos sobre um log da sessão 0xabc retendo [100, 500)
+    confereResposta(nullptr, nullptr, nullptr, 100, 500, 200, 100, 500, false, 0);
+    confereResposta(nullptr, "bytes=200-", nullptr, 100, 500, 206, 200, 500, false, 0);
+    confereResposta(nullptr, "bytes=200-299", nullptr, 100, 500, 206, 200, 300, false, 0);
+    confereResposta(nullptr, "bytes=-50", nullptr, 100, 500, 206, 450, 500, false, 0);
+    confereResposta(nullptr, "bytes=-1000", nullptr, 100, 500, 206, 100, 500, false, 0);   // sufixo cortado no retido
+    confereResposta(nullptr, "bytes=50-60", nullptr, 100, 500, 416, 500, 500, false, 0);    // já descartado
+    confereResposta(nullptr, "bytes=600-", nullptr, 100, 500, 416, 500, 500, false, 0);     // além do fim
+    confereResposta(nullptr, "bytes=1-2,5-6", nullptr, 100, 500, 200, 100, 500, false, 0);  // vira GET comum
+    confereResposta(nullptr, nullptr, "\"00000abc-500\"", 100, 500, 304, 500, 500, false, 0);
+    confereResposta(nullptr, nullptr, "*", 100, 500, 304, 500, 500, false, 0);
+    confereResposta(nullptr, nullptr, "\"00000abc-400\"", 100, 500, 200, 100, 500, false, 0); // ETag velha
+    confereResposta(nullptr, "bytes=200-", "\"00000abc-500\"", 100, 500, 304, 500, 500, false, 0);
+
+    // since: continua do cursor, relata lacuna e recomeça em outra sessão
+    confereResposta("00000abc-300", nullptr, nullptr, 100, 500, 200, 300, 500, false, 0);
+    confereResposta("00000abc-500", nullptr, nullptr, 100, 500, 204, 500, 500, false, 0);
+    confereResposta("00000abc-50", nullptr, nullptr, 100, 500, 200, 100, 500, false, 50);
+    confereResposta("00000abd-300", nullptr, nullptr, 100, 500, 200, 100, 500, true, 0);
+    confereResposta("00000abc-900", nullptr, nullptr, 100, 500, 200, 100, 500, true, 0);  // à frente do fim
+    confereResposta("lixo", nullptr, nullptr, 100, 500, 200, 100, 500, true, 0);
+    confereResposta("00000abc-300", "bytes=0-10", nullptr, 100, 500, 200, 300, 500, false, 0); // since manda
+    confereResposta("00000abd-0", nullptr, nullptr, 0, 0, 204, 0, 0, true, 0);             // zerado e vazio
+
+    // O cursor devolvido numa resposta continua exatamente de onde ela parou
+    RespostaLog r = resolvePedidoLog(nullptr, "bytes=200-299", nullptr, 0xabcu, 100, 500);
+    formataCursor(cursor, sizeof(cursor), 0xabcu, r.ate);
+    confereResposta(cursor, nullptr, nullptr, 100, 800, 200, 300, 800, false, 0);
+
+    fprintf(stderr, "%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}